@@ -12,6 +12,9 @@ namespace {
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <thread>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -113,10 +116,323 @@ bool ProcessorInfoFromOS(int& cpus, int& cores, int& logicalCores, double& clock
 	return false;
 }
 #else
-// TODO
+#include <pthread.h>
+#include <sched.h>
+#include <fstream>
+#include <string>
+
+bool ProcessorInfoFromOS(int& cpus, int& cores, int& logicalCores, double& clockSpeed);	// Defined below, on top of CpuTopology
+#endif
+
+
+// Logical processor layout of the machine: which core, package and NUMA node every
+// logical processor belongs to. Used to pin pool workers (see STL_Thread::WorkStealingPool).
+struct CpuTopology
+{
+	struct Processor
+	{
+		std::uint32_t id;		// Dense index, 0..processors.size()-1
+		std::uint32_t number;	// OS processor number (within its group on Windows)
+		std::uint16_t group;	// Processor group (Windows only, 0 elsewhere)
+		std::uint32_t core;		// Dense physical core index
+		std::uint32_t package;	// Dense package (socket) index
+		std::uint32_t node;		// Dense NUMA node index
+	};
+
+	std::vector<Processor> processors;
+	std::uint32_t cores = 0;
+	std::uint32_t packages = 0;
+	std::uint32_t nodes = 0;
+
+	// Probed once; falls back to one node/package with one core per logical processor
+	static const CpuTopology& Get()
+	{
+		static const CpuTopology topology = Probe();
+		return topology;
+	}
+
+	std::vector<std::uint32_t> NodeProcessors(std::uint32_t node) const
+	{
+		std::vector<std::uint32_t> result;
+		for (const auto& p : processors) {
+			if (p.node == node) {
+				result.push_back(p.id);
+			}
+		}
+		return result;
+	}
+
+	// Fill cores one after another, hyper-thread siblings adjacent, node by node:
+	// workers share caches and stay on as few nodes as possible
+	std::vector<std::uint32_t> Compact(std::uint32_t count) const
+	{
+		std::vector<std::uint32_t> order(processors.size());
+		for (std::uint32_t i = 0; i < order.size(); ++i) {
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+			const Processor& x = processors[a];
+			const Processor& y = processors[b];
+			if (x.node != y.node) return x.node < y.node;
+			if (x.package != y.package) return x.package < y.package;
+			return x.core < y.core;
+			});
+		return Take(order, count);
+	}
+
+	// One worker per physical core first, alternating nodes, before using any hyper-thread
+	// sibling: maximizes memory bandwidth and private cache per worker
+	std::vector<std::uint32_t> Scatter(std::uint32_t count) const
+	{
+		// Siblings of every core, cores grouped by node
+		std::vector<std::vector<std::uint32_t>> siblings(cores);
+		std::vector<std::vector<std::uint32_t>> nodeCores(nodes);
+		for (const auto& p : processors) {
+			if (siblings[p.core].empty()) {
+				nodeCores[p.node].push_back(p.core);
+			}
+			siblings[p.core].push_back(p.id);
+		}
+
+		std::vector<std::uint32_t> coreOrder;
+		for (std::size_t i = 0; coreOrder.size() < cores; ++i) {
+			for (const auto& list : nodeCores) {
+				if (i < list.size()) {
+					coreOrder.push_back(list[i]);
+				}
+			}
+		}
+
+		std::vector<std::uint32_t> order;
+		for (std::size_t round = 0; order.size() < processors.size(); ++round) {
+			for (std::uint32_t core : coreOrder) {
+				if (round < siblings[core].size()) {
+					order.push_back(siblings[core][round]);
+				}
+			}
+		}
+		return Take(order, count);
+	}
+
+	// Restrict the calling thread to one logical processor
+	bool PinCurrentThread(std::uint32_t id) const
+	{
+		if (id >= processors.size()) {
+			return false;
+		}
+		const Processor& p = processors[id];
+#ifdef _WIN32
+		GROUP_AFFINITY affinity = {};
+		affinity.Group = p.group;
+		affinity.Mask = KAFFINITY(1) << p.number;
+		return SetThreadGroupAffinity(GetCurrentThread(), &affinity, NULL) != FALSE;
+#else
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(p.number, &set);
+		return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+	}
+
+private:
+
+	// count == 0 means all processors; more workers than processors wrap around
+	std::vector<std::uint32_t> Take(const std::vector<std::uint32_t>& order, std::uint32_t count) const
+	{
+		if (count == 0) {
+			count = static_cast<std::uint32_t>(order.size());
+		}
+		std::vector<std::uint32_t> result(count);
+		for (std::uint32_t i = 0; i < count; ++i) {
+			result[i] = order[i % order.size()];
+		}
+		return result;
+	}
+
+	// Map raw OS ids (in first-seen order) to dense indices
+	static std::uint32_t Dense(std::vector<std::uint64_t>& seen, std::uint64_t key)
+	{
+		auto it = std::find(seen.begin(), seen.end(), key);
+		if (it != seen.end()) {
+			return static_cast<std::uint32_t>(it - seen.begin());
+		}
+		seen.push_back(key);
+		return static_cast<std::uint32_t>(seen.size() - 1);
+	}
+
+	static CpuTopology Probe()
+	{
+		CpuTopology t;
+		if (!ProbeFromOS(t) || t.processors.empty()) {
+			t = CpuTopology();
+			const std::uint32_t n = std::max(1u, std::thread::hardware_concurrency());
+			for (std::uint32_t i = 0; i < n; ++i) {
+				t.processors.push_back({ i, i, 0, i, 0, 0 });
+			}
+			t.cores = n;
+			t.packages = 1;
+			t.nodes = 1;
+		}
+		return t;
+	}
+
+#ifdef _WIN32
+	// GetLogicalProcessorInformationEx reports every processor group, unlike the API used by ProcessorInfoFromOS
+	static bool ProbeFromOS(CpuTopology& t)
+	{
+		DWORD length = 0;
+		GetLogicalProcessorInformationEx(RelationAll, NULL, &length);
+		if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+			return false;
+		}
+		std::vector<char> buffer(length);
+		auto* base = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data());
+		if (!GetLogicalProcessorInformationEx(RelationAll, base, &length)) {
+			return false;
+		}
+
+		auto find = [&t](WORD group, DWORD number) -> Processor* {
+			for (auto& p : t.processors) {
+				if (p.group == group && p.number == number) {
+					return &p;
+				}
+			}
+			return nullptr;
+		};
+		auto forEach = [&buffer, length](LOGICAL_PROCESSOR_RELATIONSHIP relation, auto&& fn) {
+			for (DWORD offset = 0; offset < length;) {
+				auto* info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+				if (info->Relationship == relation) {
+					fn(info);
+				}
+				offset += info->Size;
+			}
+		};
+
+		// Cores first: they enumerate every logical processor
+		forEach(RelationProcessorCore, [&t](PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX info) {
+			for (WORD g = 0; g < info->Processor.GroupCount; ++g) {
+				const GROUP_AFFINITY& mask = info->Processor.GroupMask[g];
+				for (DWORD bit = 0; bit < sizeof(KAFFINITY) * 8; ++bit) {
+					if (mask.Mask & (KAFFINITY(1) << bit)) {
+						t.processors.push_back({ static_cast<std::uint32_t>(t.processors.size()), bit, mask.Group, t.cores, 0, 0 });
+					}
+				}
+			}
+			++t.cores;
+			});
+		forEach(RelationProcessorPackage, [&t, &find](PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX info) {
+			for (WORD g = 0; g < info->Processor.GroupCount; ++g) {
+				const GROUP_AFFINITY& mask = info->Processor.GroupMask[g];
+				for (DWORD bit = 0; bit < sizeof(KAFFINITY) * 8; ++bit) {
+					if (Processor* p = (mask.Mask & (KAFFINITY(1) << bit)) ? find(mask.Group, bit) : nullptr) {
+						p->package = t.packages;
+					}
+				}
+			}
+			++t.packages;
+			});
+		forEach(RelationNumaNode, [&t, &find](PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX info) {
+			const GROUP_AFFINITY& mask = info->NumaNode.GroupMask;
+			for (DWORD bit = 0; bit < sizeof(KAFFINITY) * 8; ++bit) {
+				if (Processor* p = (mask.Mask & (KAFFINITY(1) << bit)) ? find(mask.Group, bit) : nullptr) {
+					p->node = t.nodes;
+				}
+			}
+			++t.nodes;
+			});
+		t.packages = std::max(1u, t.packages);
+		t.nodes = std::max(1u, t.nodes);
+		return true;
+	}
+#else
+	static bool ReadNumber(const std::string& path, std::uint64_t& value)
+	{
+		std::ifstream in(path);
+		return static_cast<bool>(in >> value);
+	}
+
+	// Parses sysfs cpu lists such as "0-3,8-11"
+	static std::vector<std::uint32_t> ReadList(const std::string& path)
+	{
+		std::vector<std::uint32_t> result;
+		std::ifstream in(path);
+		std::string list;
+		if (!std::getline(in, list)) {
+			return result;
+		}
+		for (std::size_t pos = 0; pos < list.size();) {
+			std::size_t end = list.find(',', pos);
+			if (end == std::string::npos) {
+				end = list.size();
+			}
+			const std::string range = list.substr(pos, end - pos);
+			const std::size_t dash = range.find('-');
+			if (!range.empty()) {
+				const std::uint32_t first = static_cast<std::uint32_t>(std::stoul(range.substr(0, dash)));
+				const std::uint32_t last = dash == std::string::npos ? first : static_cast<std::uint32_t>(std::stoul(range.substr(dash + 1)));
+				for (std::uint32_t i = first; i <= last; ++i) {
+					result.push_back(i);
+				}
+			}
+			pos = end + 1;
+		}
+		return result;
+	}
+
+	static bool ProbeFromOS(CpuTopology& t)
+	{
+		const std::string root = "/sys/devices/system/cpu/";
+		std::vector<std::uint64_t> coreKeys, packageKeys, nodeKeys;
+		for (std::uint32_t number : ReadList(root + "online"))
+		{
+			const std::string dir = root + "cpu" + std::to_string(number) + "/topology/";
+			std::uint64_t core = number, package = 0;
+			ReadNumber(dir + "core_id", core);
+			ReadNumber(dir + "physical_package_id", package);
+			const std::uint32_t id = static_cast<std::uint32_t>(t.processors.size());
+			t.processors.push_back({ id, number, 0, Dense(coreKeys, (package << 32) | core), Dense(packageKeys, package), 0 });
+		}
+
+		// Nodes are optional: kernels without NUMA support have no node directory
+		for (std::uint32_t node : ReadList("/sys/devices/system/node/online"))
+		{
+			const std::vector<std::uint32_t> list = ReadList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+			for (auto& p : t.processors) {
+				if (std::find(list.begin(), list.end(), p.number) != list.end()) {
+					p.node = Dense(nodeKeys, node);
+				}
+			}
+		}
+		t.cores = static_cast<std::uint32_t>(coreKeys.size());
+		t.packages = std::max<std::uint32_t>(1, static_cast<std::uint32_t>(packageKeys.size()));
+		t.nodes = std::max<std::uint32_t>(1, static_cast<std::uint32_t>(nodeKeys.size()));
+		return true;
+	}
+#endif
+};
+
+#ifndef _WIN32
 bool ProcessorInfoFromOS(int& cpus, int& cores, int& logicalCores, double& clockSpeed)
 {
-	return false;
+	const CpuTopology& t = CpuTopology::Get();
+	cpus = static_cast<int>(t.packages);
+	cores = static_cast<int>(t.cores);
+	logicalCores = static_cast<int>(t.processors.size());
+	clockSpeed = 0;
+
+	std::ifstream in("/proc/cpuinfo");
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.rfind("cpu MHz", 0) == 0) {
+			const std::size_t colon = line.find(':');
+			if (colon != std::string::npos) {
+				clockSpeed = std::stod(line.substr(colon + 1)) / 1000.0;
+			}
+			break;
+		}
+	}
+	return clockSpeed != 0;
 }
 #endif
 
@@ -232,5 +548,11 @@ public:
 		std::println("cpu info :{}", info);
 		//	12th Gen Intel(R) Core(TM) i5-12400F with 6 cores (HyperThreaded) @ 2.5GHz
 
+		const CpuTopology& topology = CpuTopology::Get();
+		std::println("topology : {} node(s), {} package(s), {} core(s), {} logical processor(s)",
+			topology.nodes, topology.packages, topology.cores, topology.processors.size());
+		for (const auto& p : topology.processors) {
+			std::println("  processor {} : group {} number {} core {} package {} node {}", p.id, p.group, p.number, p.core, p.package, p.node);
+		}
 	}
 };
\ No newline at end of file
@@ -24,10 +24,12 @@
 // such as close(), where we need to override the definition of an existing
 // function. To avoid conflicts at link time, everything here is in a namespace
 // which is then used globally.
+#ifdef _WIN32
 #define _SC_PAGESIZE 1
 #define _SC_PAGE_SIZE _SC_PAGESIZE
 #define _SC_NPROCESSORS_ONLN 2
 #define _SC_NPROCESSORS_CONF 2
+#endif
 
 static ALWAYS_INLINE long sc_page_size() 
 {
@@ -70,6 +72,8 @@ inline std::memory_order default_failure_memory_order
     compiler_may_unsafely_assume_unreachable();
 }
 
+// Windows-only emulation; POSIX builds take these from <sys/mman.h>.
+#ifdef _WIN32
 #define MAP_ANONYMOUS 1
 #define MAP_ANON MAP_ANONYMOUS
 #define MAP_SHARED 2
@@ -93,4 +97,6 @@ extern "C" {
     int mprotect(void* addr, size_t size, int prot);
     int munlock(const void* addr, size_t length);
     int munmap(void* addr, size_t length);
-}
\ No newline at end of file
+}
+
+#endif // _WIN32
\ No newline at end of file
@@ -2,31 +2,389 @@
 
 #include <print>
 #include <assert.h>
+#include <climits>
+#include <cstdint>
+#include <span>
+#include <bit>
+#include <iterator>
+
+#include <stdexcept>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#pragma comment(lib, "onecore.lib")
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
 
 #include "observer.h"
 #include "stl_thread.h"
 #include "SpinLock.h"
+#include "concurrentqueue.h"
 
 
 class RingBuffer : public Observer
 {
 public:
 
+	//	¼eventcountοfolly::EventCount
+	//	ȴȵǼ(prepare_wait)ٸֻ֪ͨ˵ǼʱŽں˻
+	//	޵ȴʱֻ֪ͨһڴϣϵͳ
+	class EventCount
+	{
+	public:
+
+		EventCount() noexcept = default;
+		EventCount(EventCount const&) = delete;
+		EventCount& operator=(EventCount const&) = delete;
+
+		//	ǼǵȴصǰԪ֮븴پ wait  cancel_wait
+		uint32_t prepare_wait() noexcept
+		{
+			_waiters.fetch_add(1, std::memory_order_seq_cst);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			return _epoch.load(std::memory_order_acquire);
+		}
+
+		void cancel_wait() noexcept
+		{
+			_waiters.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		//	Ԫδ仯ʱ𣬳deadlinefalse
+		template<class Clock, class Duration>
+		bool wait(uint32_t key, const std::chrono::time_point<Clock, Duration>& deadline) noexcept
+		{
+			bool ok = true;
+			while (_epoch.load(std::memory_order_acquire) == key)
+			{
+				const auto now = Clock::now();
+				if (now >= deadline) {
+					ok = false;
+					break;
+				}
+
+				FutexWait(key, std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now));
+			}
+
+			_waiters.fetch_sub(1, std::memory_order_relaxed);
+			return ok;
+		}
+
+		void notify() noexcept
+		{
+			Signal(1);
+		}
+
+		void notify_all() noexcept
+		{
+			Signal(INT_MAX);
+		}
+
+	private:
+
+		void Signal(int count) noexcept
+		{
+			//	 prepare_wait еԣҪôȴݣҪô￴ȴ
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (_waiters.load(std::memory_order_relaxed) == 0) [[likely]] {
+				return;
+			}
+
+			_epoch.fetch_add(1, std::memory_order_acq_rel);
+			FutexWake(count);
+		}
+
+		void FutexWait(uint32_t expected, std::chrono::nanoseconds timeout) noexcept
+		{
+#ifdef _WIN32
+			const auto ms = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+			::WaitOnAddress(&_epoch, &expected, sizeof(expected),
+				ms >= INFINITE ? INFINITE - 1 : static_cast<DWORD>(ms));
+#elif defined(__linux__)
+			struct timespec ts;
+			ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+			ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+			::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_epoch), FUTEX_WAIT_PRIVATE,
+				expected, &ts, nullptr, 0);
+#else
+			(void)expected;
+			std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::microseconds(50)));
+#endif
+		}
+
+		void FutexWake(int count) noexcept
+		{
+#ifdef _WIN32
+			if (count == 1) {
+				::WakeByAddressSingle(&_epoch);
+			}
+			else {
+				::WakeByAddressAll(&_epoch);
+			}
+#elif defined(__linux__)
+			::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_epoch), FUTEX_WAKE_PRIVATE,
+				count, nullptr, nullptr, 0);
+#else
+			(void)count;
+#endif
+		}
+
+		static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex requires a plain 32-bit word");
+
+		std::atomic<uint32_t> _epoch{ 0 };
+		std::atomic<uint32_t> _waiters{ 0 };
+	};
+
+	//	˫ӳڴ棺ͬһҳַӳΣ[p, p + bytes)  [p + bytes, p + 2 * bytes) Ϊ
+	//	λλÿʼȲ䶼ģһ memcpy ֱΪ I/O 
+	//	Linux ʹ memfd_create +  mmapWindows ʹ VirtualAlloc2 ռλ +  MapViewOfFile3
+	struct MirroredStorage
+	{
+		//	bytes  Granularity() ʧܷnullptr
+		static void* Allocate(std::size_t bytes) noexcept
+		{
+			assert(bytes % Granularity() == 0 && "mirrored storage must be a multiple of the allocation granularity");
+#ifdef _WIN32
+			HANDLE section = ::CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+				static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32), static_cast<DWORD>(bytes), nullptr);
+			if (section == nullptr) {
+				return nullptr;
+			}
+
+			char* placeholder = static_cast<char*>(::VirtualAlloc2(nullptr, nullptr, 2 * bytes,
+				MEM_RESERVE | MEM_RESERVE_PLACEHOLDER, PAGE_NOACCESS, nullptr, 0));
+			if (placeholder == nullptr) {
+				::CloseHandle(section);
+				return nullptr;
+			}
+
+			//	ռλ룬ֱ滻Ϊͬһ section ͼ
+			::VirtualFree(placeholder, bytes, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER);
+			void* view1 = ::MapViewOfFile3(section, nullptr, placeholder, 0, bytes,
+				MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0);
+			void* view2 = ::MapViewOfFile3(section, nullptr, placeholder + bytes, 0, bytes,
+				MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0);
+			::CloseHandle(section);	//	ͼ section 
+			if (view1 == nullptr || view2 == nullptr) {
+				if (view1) ::UnmapViewOfFile(view1); else ::VirtualFree(placeholder, 0, MEM_RELEASE);
+				if (view2) ::UnmapViewOfFile(view2); else ::VirtualFree(placeholder + bytes, 0, MEM_RELEASE);
+				return nullptr;
+			}
+			return placeholder;
+#else
+#ifdef __linux__
+			const int fd = ::memfd_create("ringbuffer", MFD_CLOEXEC);
+#else
+			char name[64];
+			std::snprintf(name, sizeof(name), "/ringbuffer_%d_%p", static_cast<int>(::getpid()), static_cast<void*>(&name));
+			const int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+			if (fd >= 0) {
+				::shm_unlink(name);
+			}
+#endif
+			if (fd < 0) {
+				return nullptr;
+			}
+
+			if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+				::close(fd);
+				return nullptr;
+			}
+
+			//	ȱ 2 * bytes ַ MAP_FIXED ͬһļӳ䵽ǰ
+			char* base = static_cast<char*>(::mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+			if (base == MAP_FAILED) {
+				::close(fd);
+				return nullptr;
+			}
+
+			void* first = ::mmap(base, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+			void* second = ::mmap(base + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+			::close(fd);
+			if (first == MAP_FAILED || second == MAP_FAILED) {
+				::munmap(base, 2 * bytes);
+				return nullptr;
+			}
+			return base;
+#endif
+		}
+
+		static void Free(void* p, std::size_t bytes) noexcept
+		{
+			if (p == nullptr) {
+				return;
+			}
+#ifdef _WIN32
+			::UnmapViewOfFile(p);
+			::UnmapViewOfFile(static_cast<char*>(p) + bytes);
+#else
+			::munmap(p, 2 * bytes);
+#endif
+		}
+
+		//	ӳȣLinux ΪҳСWindows Ϊȣͨ64KB
+		static std::size_t Granularity() noexcept
+		{
+#ifdef _WIN32
+			SYSTEM_INFO info;
+			::GetSystemInfo(&info);
+			return info.dwAllocationGranularity;
+#else
+			return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+		}
+	};
+
+	//	ҳڴ棺󻺳ʹ 2MB ҳ TLB ȱʧ
+	//	Linux  MAP_HUGETLBԤ hugetlbfs ҳʧʱ˻ͨӳ + MADV_HUGEPAGE ͸ҳ
+	//	Windows  MEM_LARGE_PAGES SeLockMemoryPrivilege Ȩޣʧʱ˻ͨ VirtualAlloc
+	struct HugePageStorage
+	{
+		//	bytes ȡҳСʧܷnullptr
+		static void* Allocate(std::size_t bytes) noexcept
+		{
+			if (bytes > SIZE_MAX - PageSize()) {
+				return nullptr;
+			}
+			bytes = RoundUp(bytes);
+#ifdef _WIN32
+			void* p = ::VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (p == nullptr) {
+				p = ::VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			}
+			return p;
+#else
+			void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+			p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+			if (p == MAP_FAILED) {
+				p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (p == MAP_FAILED) {
+					return nullptr;
+				}
+#ifdef MADV_HUGEPAGE
+				::madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+			}
+			return p;
+#endif
+		}
+
+		static void Free(void* p, std::size_t bytes) noexcept
+		{
+			if (p == nullptr) {
+				return;
+			}
+#ifdef _WIN32
+			(void)bytes;
+			::VirtualFree(p, 0, MEM_RELEASE);
+#else
+			::munmap(p, RoundUp(bytes));
+#endif
+		}
+
+		//	ҳСWindows ȡ GetLargePageMinimumƽ̨ 2MB 
+		static std::size_t PageSize() noexcept
+		{
+#ifdef _WIN32
+			const std::size_t size = ::GetLargePageMinimum();
+			return size != 0 ? size : (std::size_t(2) << 20);
+#else
+			return std::size_t(2) << 20;
+#endif
+		}
+
+	private:
+
+		static std::size_t RoundUp(std::size_t bytes) noexcept
+		{
+			const std::size_t page = PageSize();
+			return (bytes + page - 1) / page * page;
+		}
+	};
+
+	struct DefultTraits
+	{
+		static constexpr uint32_t kSpinCutoff = 2000;	//	ѡȴԴ
+		static constexpr std::chrono::nanoseconds kSleepNs{ 200 };		//	˯ʱ
+		static constexpr bool kBlocking = false;		//	Ƿ֧ wait_read/wait_write ȴ
+		static constexpr bool kCachedIndex = true;		//	SPSC Ƿ񻺴Էλãٿ˻д
+		static constexpr bool kMirrored = false;		//	SPSC Ƿʹ˫ӳ洢
+		static constexpr bool kHugePages = false;		//	SPSC Ƿʹôҳ洢
+		using IndexType = uint32_t;						//	SPSC дλͣuint64_t ʱɳ 4G Ԫ
+	};
+
+	struct Traits1 : public DefultTraits
+	{
+		//	Զ
+		static constexpr uint32_t kSpinCutoff = 5000;
+		static constexpr std::chrono::nanoseconds kSleepNs{ 200 };
+	};
+
+	//	ģʽе/߹EventCountϣռCPU
+	struct BlockingTraits : public DefultTraits
+	{
+		static constexpr bool kBlocking = true;
+	};
+
+	//	ÿβȡԷλã kCachedIndex ܶԱ
+	struct UncachedTraits : public DefultTraits
+	{
+		static constexpr bool kCachedIndex = false;
+	};
+
+	//	˫ӳ洢дһ memcpyclaim/front 䲻ٱ洢βض
+	//	ȡӳȣֿ֧ƽƵ
+	struct MirroredTraits : public DefultTraits
+	{
+		static constexpr bool kMirrored = true;
+	};
+
+	//	󻺳طţ64λдλ + ҳ洢ɳ 4G Ԫ
+	struct LargeTraits : public DefultTraits
+	{
+		static constexpr bool kHugePages = true;
+		using IndexType = uint64_t;
+	};
+
 	//	ѻλ1д1
-	template<class T>
+	template<class T, typename Traits = DefultTraits>
 	class SPSCRingBuffer
 	{
 	public:
 
-		explicit SPSCRingBuffer(uint32_t capacity)
-			: _size(NextPowerOfTwo(capacity))
+		using index_type = typename Traits::IndexType;
+
+		//	start ΪдλõĳʼֵһΪ0ʱ㸽֤
+		explicit SPSCRingBuffer(index_type capacity, index_type start = 0)
+			: _size(StorageSize(capacity))
 			, _mask(_size - 1)
-			, _storage(static_cast<T*>(std::malloc(sizeof(T) * _size)))
-			, _rpos(0)
-			, _wpos(0)
+			, _storage(AllocateStorage(_size))
+			, _rpos(start)
+			, _wpos(start)
+			, _rposCache(start)
+			, _wposCache(start)
 		{
 			static_assert(std::is_nothrow_destructible<T>::value,
 				"SPSCRingBuffer requires a nothrow destructible type");
+			static_assert(!Traits::kMirrored || std::is_trivially_copyable_v<T>,
+				"mirrored SPSCRingBuffer requires a trivially copyable type");
+			static_assert(!(Traits::kMirrored && Traits::kHugePages),
+				"SPSCRingBuffer cannot combine mirrored and huge page storage");
+			static_assert(std::is_unsigned_v<index_type> && sizeof(index_type) >= sizeof(uint32_t),
+				"SPSCRingBuffer index type must be uint32_t or uint64_t");
 			assert(_size >= 2 && "SPSCRingBuffer size must be at least 2");
 			if (_storage == nullptr)
 			{
@@ -36,15 +394,23 @@ public:
 
 		~SPSCRingBuffer()
 		{
-			uint32_t rpos = _rpos.load(std::memory_order_relaxed);
-			const uint32_t wpos = _wpos.load(std::memory_order_relaxed);
+			index_type rpos = _rpos.load(std::memory_order_relaxed);
+			const index_type wpos = _wpos.load(std::memory_order_relaxed);
 			while (rpos != wpos)
 			{
 				_storage[rpos & _mask].~T();
 				++rpos;
 			}
 
-			std::free(_storage);
+			if constexpr (Traits::kMirrored) {
+				MirroredStorage::Free(_storage, sizeof(T) * _size);
+			}
+			else if constexpr (Traits::kHugePages) {
+				HugePageStorage::Free(_storage, sizeof(T) * _size);
+			}
+			else {
+				std::free(_storage);
+			}
 		}
 
 		bool empty() const noexcept
@@ -54,10 +420,10 @@ public:
 
 		bool full() const noexcept
 		{
-			return (_wpos.load(std::memory_order_acquire) + 1) == _rpos.load(std::memory_order_acquire);
+			return _wpos.load(std::memory_order_acquire) - _rpos.load(std::memory_order_acquire) >= capacity();
 		}
 
-		uint32_t capacity() const noexcept
+		index_type capacity() const noexcept
 		{ 
 			return _size - 1;
 		}
@@ -65,74 +431,299 @@ public:
 		template<typename... Args>
 		bool write(Args&&... args)
 		{
-			const uint32_t wpos = _wpos.load(std::memory_order_relaxed);
-			const uint32_t next_wpos = wpos + 1;
-			if (next_wpos - _rpos.load(std::memory_order_acquire) >= _size) {
+			const index_type wpos = _wpos.load(std::memory_order_relaxed);
+			if (writable_count(wpos, 1) == 0) {
 				return false; // full
 			}
 
 			new (&_storage[wpos & _mask]) T(std::forward<Args>(args)...);
-			_wpos.store(next_wpos, std::memory_order_release);
+			_wpos.store(wpos + 1, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				_readable.notify();
+			}
 			return true;
 		}
 
+		//	д룺 kSpinCutoff ΣȻȴ֪ͨʱfalse
+		template<class Rep, class Period, typename... Args>
+		bool wait_write(const std::chrono::duration<Rep, Period>& timeout, Args&&... args)
+		{
+			static_assert(Traits::kBlocking, "wait_write requires Traits::kBlocking");
+			for (uint32_t spin = 0; spin < Traits::kSpinCutoff; ++spin) {
+				if (!full_for_writer()) {
+					return write(std::forward<Args>(args)...);
+				}
+				asm_volatile_pause();
+			}
+
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			while (full_for_writer())
+			{
+				const uint32_t key = _writable.prepare_wait();
+				if (!full_for_writer()) {
+					_writable.cancel_wait();
+					break;
+				}
+
+				if (!_writable.wait(key, deadline)) {
+					break;
+				}
+			}
+
+			return write(std::forward<Args>(args)...);
+		}
+
 		template<typename Iterator>
-		uint32_t write_bulk(Iterator begin, uint32_t count)
+		index_type write_bulk(Iterator begin, index_type count)
 		{
-			const uint32_t wpos = _wpos.load(std::memory_order_relaxed);
-			const uint32_t rpos = _rpos.load(std::memory_order_acquire);
-			const uint32_t cap = capacity() - (wpos - rpos);
-			const uint32_t num = std::min(count, cap);
-			for (uint32_t i = 0; i < num; ++i) {
-				new (&_storage[(wpos + i) & _mask]) T(std::move(*begin++));
+			const index_type wpos = _wpos.load(std::memory_order_relaxed);
+			const index_type num = std::min(count, writable_count(wpos, count));
+			if constexpr (kContiguousCopy<Iterator>) {
+				std::memcpy(&_storage[wpos & _mask], std::to_address(begin), sizeof(T) * num);
+			}
+			else {
+				for (index_type i = 0; i < num; ++i) {
+					new (&_storage[(wpos + i) & _mask]) T(std::move(*begin++));
+				}
 			}
 
 			_wpos.store(wpos + num, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				if (num > 0) {
+					_readable.notify();
+				}
+			}
 			return num;
 		}
 
 		template<typename Iterator>
-		uint32_t write_bulk(Iterator begin, Iterator end)
+		index_type write_bulk(Iterator begin, Iterator end)
 		{
-			return write_bulk(begin, static_cast<uint32_t>(std::distance(begin, end)));
+			return write_bulk(begin, static_cast<index_type>(std::distance(begin, end)));
 		}
 
 		bool read(T& item)
 		{
-			const uint32_t rpos = _rpos.load(std::memory_order_relaxed);
-			if (rpos == _wpos.load(std::memory_order_acquire)) {
+			const index_type rpos = _rpos.load(std::memory_order_relaxed);
+			if (readable_count(rpos, 1) == 0) {
 				return false; // empty
 			}
 
 			item = std::move(_storage[rpos & _mask]);
 			_storage[rpos & _mask].~T();
 			_rpos.store(rpos + 1, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				_writable.notify();
+			}
 			return true;
 		}
 
+		//	ȡ kSpinCutoff ΣȻΪȴ֪ͨʱfalse
+		template<class Rep, class Period>
+		bool wait_read(T& item, const std::chrono::duration<Rep, Period>& timeout)
+		{
+			static_assert(Traits::kBlocking, "wait_read requires Traits::kBlocking");
+			for (uint32_t spin = 0; spin < Traits::kSpinCutoff; ++spin) {
+				if (read(item)) {
+					return true;
+				}
+				asm_volatile_pause();
+			}
+
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			while (empty())
+			{
+				const uint32_t key = _readable.prepare_wait();
+				if (!empty()) {
+					_readable.cancel_wait();
+					break;
+				}
+
+				if (!_readable.wait(key, deadline)) {
+					break;
+				}
+			}
+
+			return read(item);
+		}
+
 		template<typename Iterator>
-		uint32_t read_bulk(Iterator begin, uint32_t count)
+		index_type read_bulk(Iterator begin, index_type count)
 		{
-			const uint32_t rpos = _rpos.load(std::memory_order_relaxed);
-			const uint32_t wpos = _wpos.load(std::memory_order_acquire);
-			const uint32_t has = wpos - rpos;
-			const uint32_t num = std::min(count, has);
-			for (uint32_t i = 0; i < num; ++i) {
-				*begin++ = std::move(_storage[(rpos + i) & _mask]);
-				_storage[(rpos + i) & _mask].~T();
+			const index_type rpos = _rpos.load(std::memory_order_relaxed);
+			const index_type num = std::min(count, readable_count(rpos, count));
+			if constexpr (kContiguousCopy<Iterator>) {
+				std::memcpy(std::to_address(begin), &_storage[rpos & _mask], sizeof(T) * num);
+			}
+			else {
+				for (index_type i = 0; i < num; ++i) {
+					*begin++ = std::move(_storage[(rpos + i) & _mask]);
+					_storage[(rpos + i) & _mask].~T();
+				}
 			}
 
 			_rpos.store(rpos + num, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				if (num > 0) {
+					_writable.notify();
+				}
+			}
 			return num;
 		}
 
+		//	㿽ӿڣֱڻδ洢ϹݣֱӶȡλʡȥмƶ
+		//	claim_write δĲλʱnullptr placement new  T  commit_write 
+		T* claim_write() noexcept
+		{
+			const index_type wpos = _wpos.load(std::memory_order_relaxed);
+			if (writable_count(wpos, 1) == 0) {
+				return nullptr; // full
+			}
+
+			return &_storage[wpos & _mask];
+		}
+
+		//	룺شдλÿʼδλʣռʹ洢βƣ˫ӳʱβƣСcount
+		std::span<T> claim_write_bulk(index_type count) noexcept
+		{
+			const index_type wpos = _wpos.load(std::memory_order_relaxed);
+			const index_type idx = wpos & _mask;
+			const index_type num = std::min(std::min(count, writable_count(wpos, count)), contiguous_count(idx));
+			return { &_storage[idx], num };
+		}
+
+		//	ѹ count λcount ܳ claim õ
+		void commit_write(index_type count = 1) noexcept
+		{
+			_wpos.store(_wpos.load(std::memory_order_relaxed) + count, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				_readable.notify();
+			}
+		}
+
+		//	ȡԪصӣʱnullptr
+		const T* front() const noexcept
+		{
+			const index_type rpos = _rpos.load(std::memory_order_relaxed);
+			if (readable_count(rpos, 1) == 0) {
+				return nullptr; // empty
+			}
+
+			return &_storage[rpos & _mask];
+		}
+
+		//	ȡشӶλÿʼɶλܿɶʹ洢βƣ˫ӳʱβƣСcount
+		std::span<const T> front_bulk(index_type count) const noexcept
+		{
+			const index_type rpos = _rpos.load(std::memory_order_relaxed);
+			const index_type idx = rpos & _mask;
+			const index_type num = std::min(std::min(count, readable_count(rpos, count)), contiguous_count(idx));
+			return { &_storage[idx], num };
+		}
+
+		//	 count Ԫأcount ܳ front/front_bulk õ
+		void pop(index_type count = 1) noexcept
+		{
+			const index_type rpos = _rpos.load(std::memory_order_relaxed);
+			for (index_type i = 0; i < count; ++i) {
+				_storage[(rpos + i) & _mask].~T();
+			}
+
+			_rpos.store(rpos + count, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				_writable.notify();
+			}
+		}
+
 		SPSCRingBuffer(SPSCRingBuffer const&) = delete;
 		SPSCRingBuffer& operator=(SPSCRingBuffer const&) = delete;
 		SPSCRingBuffer& operator=(SPSCRingBuffer&& rhs) = delete;
 
 	private:
 
-		static uint32_t NextPowerOfTwo(uint32_t n) noexcept
+		//	˫ӳʱƽƵ֮һ memcpy
+		template<typename Iterator>
+		static constexpr bool kContiguousCopy = Traits::kMirrored && std::contiguous_iterator<Iterator>
+			&& std::is_same_v<std::iter_value_t<Iterator>, T>;
+
+		//	 idx ʼԽ洢βĲλ
+		index_type contiguous_count(index_type idx) const noexcept
+		{
+			if constexpr (Traits::kMirrored) {
+				return _size;
+			}
+			else {
+				return _size - idx;
+			}
+		}
+
+		static index_type StorageSize(index_type capacity) noexcept
+		{
+			index_type size = NextPowerOfTwo(capacity);
+			if constexpr (Traits::kMirrored) {
+				//	sizeof(T) * size ӳȵ
+				const std::size_t min_size = std::max<std::size_t>(1, MirroredStorage::Granularity() >> std::countr_zero(sizeof(T)));
+				size = std::max<index_type>(size, static_cast<index_type>(min_size));
+			}
+			return size;
+		}
+
+		//	 index_type Χsize Ϊ0ֽ size_t ʱnullptr
+		static T* AllocateStorage(index_type size) noexcept
+		{
+			if (size == 0 || size > SIZE_MAX / sizeof(T)) {
+				return nullptr;
+			}
+
+			if constexpr (Traits::kMirrored) {
+				return static_cast<T*>(MirroredStorage::Allocate(sizeof(T) * size));
+			}
+			else if constexpr (Traits::kHugePages) {
+				return static_cast<T*>(HugePageStorage::Allocate(sizeof(T) * size));
+			}
+			else {
+				return static_cast<T*>(std::malloc(sizeof(T) * size));
+			}
+		}
+
+		//	ӽǵĿдûĶλü㣬 need ʱȥȡߵĻ
+		index_type writable_count(index_type wpos, index_type need) noexcept
+		{
+			if constexpr (Traits::kCachedIndex) {
+				index_type free = capacity() - (wpos - _rposCache);
+				if (free < need) {
+					_rposCache = _rpos.load(std::memory_order_acquire);
+					free = capacity() - (wpos - _rposCache);
+				}
+				return free;
+			}
+			else {
+				return capacity() - (wpos - _rpos.load(std::memory_order_acquire));
+			}
+		}
+
+		//	ӽǵĿɶûдλü㣬 need ʱȥȡߵĻ
+		index_type readable_count(index_type rpos, index_type need) const noexcept
+		{
+			if constexpr (Traits::kCachedIndex) {
+				index_type has = _wposCache - rpos;
+				if (has < need) {
+					_wposCache = _wpos.load(std::memory_order_acquire);
+					has = _wposCache - rpos;
+				}
+				return has;
+			}
+			else {
+				return _wpos.load(std::memory_order_acquire) - rpos;
+			}
+		}
+
+		bool full_for_writer() const noexcept
+		{
+			return _wpos.load(std::memory_order_relaxed) + 1 - _rpos.load(std::memory_order_acquire) >= _size;
+		}
+
+		static index_type NextPowerOfTwo(index_type n) noexcept
 		{
 			if (n == 0) return 1;
 
@@ -142,30 +733,27 @@ public:
 			n |= n >> 4;
 			n |= n >> 8;
 			n |= n >> 16;
+			if constexpr (sizeof(index_type) > sizeof(uint32_t)) {
+				n |= n >> 32;
+			}
 			return n + 1;
 		}
 
 		static constexpr std::size_t kCacheLine = 64;
 
-		alignas(kCacheLine) std::atomic<uint32_t> _wpos;
-		alignas(kCacheLine) std::atomic<uint32_t> _rpos;
+		//	ԵλԷλõıػͬһУֻлʾ/ʱŷʶԷĻ
+		alignas(kCacheLine) std::atomic<index_type> _wpos;
+		index_type _rposCache;				//	˽
+		alignas(kCacheLine) std::atomic<index_type> _rpos;
+		mutable index_type _wposCache;		//	˽
 
-		const uint32_t _size;
-		const uint32_t _mask;
-		T* const _storage;
-	};
-
-	struct DefultTraits
-	{
-		static constexpr uint32_t kSpinCutoff = 2000;	//	ѡȴԴ
-		static constexpr std::chrono::nanoseconds kSleepNs{ 200 };		//	˯ʱ
-	};
+		//	 Traits::kBlocking ʱʹ
+		alignas(kCacheLine) EventCount _readable;	//	 -> 
+		EventCount _writable;						//	 -> 
 
-	struct Traits1 : public DefultTraits
-	{
-		//	Զ
-		static constexpr uint32_t kSpinCutoff = 5000;
-		static constexpr std::chrono::nanoseconds kSleepNs{ 200 };
+		const index_type _size;
+		const index_type _mask;
+		T* const _storage;
 	};
 
 	//	ѻλ
@@ -225,6 +813,9 @@ public:
 
 			new (&_storage[ticket & _mask]) T(item);
 			_wpos.store(ticket + 1, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				_readable.notify();
+			}
 		}
 
 		void write(T&& item)
@@ -246,6 +837,9 @@ public:
 
 			new (&_storage[ticket & _mask]) T(std::forward<T>(item));
 			_wpos.store(ticket + 1, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				_readable.notify();
+			}
 		}
 
 		template<typename... Args>
@@ -274,19 +868,42 @@ public:
 			//std::print("thread id: {}, writting ticket: {}.\n", std::this_thread::get_id(), ticket);
 			new (&_storage[ticket & _mask]) T(std::forward<Args>(args)...);
 			_wpos.store(ticket + 1, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				_readable.notify();
+			}
 		}
 
-		bool read(T& item)
+		//	д룺һ fetch_add ԤԼ count λãֵдһԷ
+		//	count ʱֶд룬ԶȲ㹻Ŀռ䣬һֱռд˳סд
+		template<typename Iterator>
+		uint32_t write_bulk(Iterator begin, uint32_t count)
 		{
-			const uint64_t rpre = _rpre.load(std::memory_order_acquire);
-			if (rpre == _wpos.load(std::memory_order_acquire)) {
-				//std::print("thread id: {}, pre read faild, pre is full: {}.\n", std::this_thread::get_id(), rpre);
-				return false; // ԤԼ
+			uint32_t written = 0;
+			while (written < count) {
+				const uint32_t chunk = static_cast<uint32_t>(std::min<uint64_t>(count - written, _size));
+				write_chunk(begin, chunk);
+				written += chunk;
 			}
+			return written;
+		}
 
-			// !!! ܻж߳̽ʱ_wposֻ_repre1 ԤԼͶȡ
-			uint64_t ticket = _rpre++;
-			uint32_t spinCount = 0;
+		template<typename Iterator>
+		uint32_t write_bulk(Iterator begin, Iterator end)
+		{
+			return write_bulk(begin, static_cast<uint32_t>(std::distance(begin, end)));
+		}
+
+		bool read(T& item)
+		{
+			const uint64_t rpre = _rpre.load(std::memory_order_acquire);
+			if (rpre == _wpos.load(std::memory_order_acquire)) {
+				//std::print("thread id: {}, pre read faild, pre is full: {}.\n", std::this_thread::get_id(), rpre);
+				return false; // ԤԼ
+			}
+
+			// !!! ܻж߳̽ʱ_wposֻ_repre1 ԤԼͶȡ
+			uint64_t ticket = _rpre++;
+			uint32_t spinCount = 0;
 			//std::print("thread id: {}, pre read ticket: {}.\n", std::this_thread::get_id(), ticket);
 
 			//	ȴֵɶ
@@ -305,16 +922,184 @@ public:
 			item = std::move(_storage[ticket & _mask]);
 			_storage[ticket & _mask].~T();
 			_rpos.store(ticket + 1, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				_writable.notify();
+			}
 			//std::print("thread id: {}, reading ticket: {} data: {}.\n", std::this_thread::get_id(), ticket, item.data);
 			return true;
 		}
 
+		//	ȡCAS һԤԼ count ѷλãԤԼԭɣԽ _wpos
+		//	read  _rpre++ ھܰ _rpre Ƶ _wpos ֮󣬴ʱմòֵ
+		template<typename Iterator>
+		uint32_t read_bulk(Iterator begin, uint32_t count)
+		{
+			uint64_t ticket = _rpre.load(std::memory_order_acquire);
+			uint32_t num;
+			do {
+				const uint64_t wpos = _wpos.load(std::memory_order_acquire);
+				if (ticket >= wpos) {
+					return 0; // empty
+				}
+				num = static_cast<uint32_t>(std::min<uint64_t>(count, wpos - ticket));
+				if (num == 0) {
+					return 0;
+				}
+			} while (!_rpre.compare_exchange_weak(ticket, ticket + num,
+				std::memory_order_acq_rel, std::memory_order_acquire));
+
+			wait_turn(_rpos, ticket);
+
+			for (uint32_t i = 0; i < num; ++i) {
+				*begin++ = std::move(_storage[(ticket + i) & _mask]);
+				_storage[(ticket + i) & _mask].~T();
+			}
+
+			_rpos.store(ticket + num, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				_writable.notify_all();
+			}
+			return num;
+		}
+
+		//	ȡEventCountϵȴд֪ͨȡѯ sleep_forʱfalse
+		template<class Rep, class Period>
+		bool wait_read(T& item, const std::chrono::duration<Rep, Period>& timeout)
+		{
+			static_assert(Traits::kBlocking, "wait_read requires Traits::kBlocking");
+			for (uint32_t spin = 0; spin < Traits::kSpinCutoff; ++spin) {
+				if (read(item)) {
+					return true;
+				}
+				asm_volatile_pause();
+			}
+
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			for (;;)
+			{
+				if (read(item)) {
+					return true;
+				}
+
+				const uint32_t key = _readable.prepare_wait();
+				if (!empty_for_reader()) {
+					_readable.cancel_wait();
+					continue;
+				}
+
+				if (!_readable.wait(key, deadline)) {
+					return read(item);
+				}
+			}
+		}
+
+		//	д룺ʱȴȡ֪ͨʱfalse
+		//	CAS ԤԼдλãֻ ticket ӦĲλѱʱԤԼɹ_rpos ֻֻ֮ȴֵԼḲδ
+		//	ʱֻԤԼ֮ǰԶд ticket
+		template<class Rep, class Period, typename... Args>
+		bool wait_write(const std::chrono::duration<Rep, Period>& timeout, Args&&... args)
+		{
+			static_assert(Traits::kBlocking, "wait_write requires Traits::kBlocking");
+			uint32_t spinCount = 0;
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			bool timed_out = false;
+			uint64_t ticket;
+			for (;;)
+			{
+				//	ȶ _rpos ٶ _wpre֤ ticket >= rposֵ
+				const uint64_t rpos = _rpos.load(std::memory_order_acquire);
+				ticket = _wpre.load(std::memory_order_acquire);
+				if (ticket + 1 - rpos <= _size) {
+					if (_wpre.compare_exchange_weak(ticket, ticket + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+						break;
+					}
+					continue;
+				}
+
+				if (timed_out) {
+					return false;
+				}
+
+				if (++spinCount <= Traits::kSpinCutoff) {
+					asm_volatile_pause();
+					continue;
+				}
+
+				const uint32_t key = _writable.prepare_wait();
+				if (!full_for_writer()) {
+					_writable.cancel_wait();
+					continue;
+				}
+				timed_out = !_writable.wait(key, deadline);
+			}
+
+			wait_turn(_wpos, ticket);
+			new (&_storage[ticket & _mask]) T(std::forward<Args>(args)...);
+			_wpos.store(ticket + 1, std::memory_order_release);
+			_readable.notify();
+			return true;
+		}
+
 		MPMCRingBuffer(MPMCRingBuffer const&) = delete;
 		MPMCRingBuffer& operator=(MPMCRingBuffer const&) = delete;
 		MPMCRingBuffer& operator=(MPMCRingBuffer&& rhs) = delete;
 
 	private:
 
+		//	д벻һΣbegin дǰ
+		template<typename Iterator>
+		void write_chunk(Iterator& begin, uint32_t count)
+		{
+			const uint64_t ticket = _wpre.fetch_add(count);
+			wait_turn(_wpos, ticket);
+
+			//	ֵԼٵȶڳοռ䣬⸲δߵ
+			uint32_t spinCount = 0;
+			while (ticket + count - _rpos.load(std::memory_order_acquire) > _size)
+			{
+				if (++spinCount > Traits::kSpinCutoff) {
+					std::this_thread::sleep_for(Traits::kSleepNs);
+				}
+				else {
+					asm_volatile_pause();
+				}
+			}
+
+			for (uint32_t i = 0; i < count; ++i) {
+				new (&_storage[(ticket + i) & _mask]) T(std::move(*begin++));
+			}
+
+			_wpos.store(ticket + count, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				_readable.notify_all();
+			}
+		}
+
+		//	ȴ pos ֵ ticket kSpinCutoff ˯
+		static void wait_turn(const std::atomic<uint64_t>& pos, uint64_t ticket) noexcept
+		{
+			uint32_t spinCount = 0;
+			while (pos.load(std::memory_order_acquire) != ticket)
+			{
+				if (++spinCount > Traits::kSpinCutoff) {
+					std::this_thread::sleep_for(Traits::kSleepNs);
+				}
+				else {
+					asm_volatile_pause();
+				}
+			}
+		}
+
+		bool empty_for_reader() const noexcept
+		{
+			return _rpre.load(std::memory_order_acquire) == _wpos.load(std::memory_order_acquire);
+		}
+
+		bool full_for_writer() const noexcept
+		{
+			return _wpre.load(std::memory_order_acquire) - _rpos.load(std::memory_order_acquire) >= _size;
+		}
+
 		static uint32_t NextPowerOfTwo(uint32_t n) noexcept
 		{
 			if (n == 0) return 1;
@@ -328,74 +1113,1424 @@ public:
 			return n + 1;
 		}
 
-		static constexpr std::size_t kCacheLine = 64;
+		static constexpr std::size_t kCacheLine = 64;
+
+		//	ʵĶдλ
+		alignas(kCacheLine) std::atomic<uint64_t> _wpos;
+		alignas(kCacheLine) std::atomic<uint64_t> _rpos;
+
+		//	ԤԼԱ¼ԤԼȥλ
+		//  дԤԼܳʵʿɶλãԤԼܳʵʿдλ
+		alignas(kCacheLine) std::atomic<uint64_t> _wpre;
+		alignas(kCacheLine) std::atomic<uint64_t> _rpre;
+
+		//	 Traits::kBlocking ʱʹ
+		alignas(kCacheLine) EventCount _readable;
+		EventCount _writable;
+
+		const uint64_t _size;
+		const uint64_t _mask;
+		T* const _storage;
+	};
+
+	//	н绷ζУÿλţο Dmitry Vyukov bounded MPMC queue
+	//	λ == дλ ʾд== дλ+1 ʾɶΪ λ+_size һ
+	//	дֻλһCASȴ߳ɣ/ջλδʱ try_* ֱӷfalse
+	//	ע⣺T Ĺ첻쳣ĲλԶᷢ
+	template<class T, typename Traits = DefultTraits>
+	class MPMCSlotRingBuffer
+	{
+	public:
+
+		explicit MPMCSlotRingBuffer(uint32_t capacity = 2048)
+			: _size(NextPowerOfTwo(capacity))
+			, _mask(_size - 1)
+			, _slots(static_cast<Slot*>(::operator new(sizeof(Slot) * _size, std::align_val_t{ alignof(Slot) })))
+			, _wpos(0)
+			, _rpos(0)
+		{
+			static_assert(std::is_nothrow_destructible<T>::value,
+				"MPMCSlotRingBuffer requires a nothrow destructible type");
+			assert(_size >= 2 && "MPMCSlotRingBuffer size must be at least 2");
+			for (uint64_t i = 0; i < _size; ++i) {
+				new (&_slots[i].seq) std::atomic<uint64_t>(i);
+			}
+		}
+
+		~MPMCSlotRingBuffer()
+		{
+			uint64_t rpos = _rpos.load(std::memory_order_relaxed);
+			const uint64_t wpos = _wpos.load(std::memory_order_relaxed);
+			for (; rpos != wpos; ++rpos)
+			{
+				Slot& slot = _slots[rpos & _mask];
+				if (slot.seq.load(std::memory_order_relaxed) == rpos + 1) {
+					slot.ptr()->~T();
+				}
+			}
+
+			::operator delete(_slots, std::align_val_t{ alignof(Slot) });
+		}
+
+		bool empty() const noexcept
+		{
+			return _rpos.load(std::memory_order_acquire) >= _wpos.load(std::memory_order_acquire);
+		}
+
+		uint32_t capacity() const noexcept
+		{
+			return static_cast<uint32_t>(_size);
+		}
+
+		template<typename... Args>
+		bool try_write(Args&&... args)
+		{
+			uint64_t pos = _wpos.load(std::memory_order_relaxed);
+			Slot* slot;
+			for (;;)
+			{
+				slot = &_slots[pos & _mask];
+				const uint64_t seq = slot->seq.load(std::memory_order_acquire);
+				const int64_t diff = static_cast<int64_t>(seq - pos);
+				if (diff == 0) {
+					if (_wpos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				}
+				else if (diff < 0) {
+					return false; // fullλδһֶ
+				}
+				else {
+					pos = _wpos.load(std::memory_order_relaxed);	//	д
+				}
+			}
+
+			new (slot->data) T(std::forward<Args>(args)...);
+			slot->seq.store(pos + 1, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				_readable.notify();
+			}
+			return true;
+		}
+
+		bool try_read(T& item)
+		{
+			uint64_t pos = _rpos.load(std::memory_order_relaxed);
+			Slot* slot;
+			for (;;)
+			{
+				slot = &_slots[pos & _mask];
+				const uint64_t seq = slot->seq.load(std::memory_order_acquire);
+				const int64_t diff = static_cast<int64_t>(seq - (pos + 1));
+				if (diff == 0) {
+					if (_rpos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				}
+				else if (diff < 0) {
+					return false; // emptyд뵫δ
+				}
+				else {
+					pos = _rpos.load(std::memory_order_relaxed);	//	
+				}
+			}
+
+			T* ptr = slot->ptr();
+			item = std::move(*ptr);
+			ptr->~T();
+			slot->seq.store(pos + _size, std::memory_order_release);
+			if constexpr (Traits::kBlocking) {
+				_writable.notify();
+			}
+			return true;
+		}
+
+		//	д룺ȴȡ֪ͨʱfalse
+		template<class Rep, class Period, typename... Args>
+		bool wait_write(const std::chrono::duration<Rep, Period>& timeout, Args&&... args)
+		{
+			static_assert(Traits::kBlocking, "wait_write requires Traits::kBlocking");
+			return wait_for(_writable, timeout, [&]() { return try_write(std::forward<Args>(args)...); });
+		}
+
+		//	ȡȴд֪ͨʱfalse
+		template<class Rep, class Period>
+		bool wait_read(T& item, const std::chrono::duration<Rep, Period>& timeout)
+		{
+			static_assert(Traits::kBlocking, "wait_read requires Traits::kBlocking");
+			return wait_for(_readable, timeout, [&]() { return try_read(item); });
+		}
+
+		MPMCSlotRingBuffer(MPMCSlotRingBuffer const&) = delete;
+		MPMCSlotRingBuffer& operator=(MPMCSlotRingBuffer const&) = delete;
+		MPMCSlotRingBuffer& operator=(MPMCSlotRingBuffer&& rhs) = delete;
+
+	private:
+
+		static constexpr std::size_t kCacheLine = 64;
+
+		//	ÿλռУڲλĶд߻α
+		struct alignas(kCacheLine) Slot
+		{
+			std::atomic<uint64_t> seq;
+			alignas(T) std::byte data[sizeof(T)];
+
+			T* ptr() noexcept { return std::launder(reinterpret_cast<T*>(data)); }
+		};
+
+		//	try_op ʧܺٵǼǵ ec ϹʧܺǼһΣⶪʧ֪ͨ
+		template<class Rep, class Period, typename TryOp>
+		bool wait_for(EventCount& ec, const std::chrono::duration<Rep, Period>& timeout, TryOp&& try_op)
+		{
+			for (uint32_t spin = 0; spin < Traits::kSpinCutoff; ++spin) {
+				if (try_op()) {
+					return true;
+				}
+				asm_volatile_pause();
+			}
+
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			for (;;)
+			{
+				const uint32_t key = ec.prepare_wait();
+				if (try_op()) {
+					ec.cancel_wait();
+					return true;
+				}
+
+				if (!ec.wait(key, deadline)) {
+					return try_op();
+				}
+			}
+		}
+
+		static uint64_t NextPowerOfTwo(uint64_t n) noexcept
+		{
+			if (n == 0) return 1;
+
+			n--;
+			n |= n >> 1;
+			n |= n >> 2;
+			n |= n >> 4;
+			n |= n >> 8;
+			n |= n >> 16;
+			n |= n >> 32;
+			return n + 1;
+		}
+
+		const uint64_t _size;
+		const uint64_t _mask;
+		Slot* const _slots;
+
+		alignas(kCacheLine) std::atomic<uint64_t> _wpos;
+		alignas(kCacheLine) std::atomic<uint64_t> _rpos;
+
+		//	 Traits::kBlocking ʱʹ
+		alignas(kCacheLine) EventCount _readable;
+		EventCount _writable;
+	};
+
+	//	䳤ֽڻλڴл֡ϢΪÿϢڴ
+	//	ÿ¼ = 16ֽͷ + أ16ֽڶ룻洢βŲʱд¼¼
+	//	ͷ tag  ¼λ+1 Ϊǣֻ뵱ǰλƥ tagʱ¼ռÿ뵥Ԫͷ tag λãһֲĸزᱻͷ
+	//	MultiProducer = true ʱдλͨ CAS ԤԼֶ֧
+	template<bool MultiProducer = false>
+	class ByteRingBuffer
+	{
+	public:
+
+		explicit ByteRingBuffer(uint32_t capacity)
+			: _size(NextPowerOfTwo(std::max<uint32_t>(capacity, 2 * kAlign)))
+			, _mask(_size - 1)
+			, _storage(static_cast<std::byte*>(::operator new(_size, std::align_val_t{ kCacheLine })))
+			, _wpos(0)
+			, _rpos(0)
+		{
+			std::memset(_storage, 0, _size);
+		}
+
+		~ByteRingBuffer()
+		{
+			::operator delete(_storage, std::align_val_t{ kCacheLine });
+		}
+
+		uint32_t capacity() const noexcept
+		{
+			return static_cast<uint32_t>(_size);
+		}
+
+		//	Ϣ󳤶ȣ֤дλ£䣩ԤԼɹ
+		uint32_t max_message_size() const noexcept
+		{
+			return static_cast<uint32_t>(_size / 2 - sizeof(Header));
+		}
+
+		bool empty() const noexcept
+		{
+			return _rpos.load(std::memory_order_acquire) == _wpos.load(std::memory_order_acquire);
+		}
+
+		//	ԤԼ n ֽڵռ䣬ռ䲻㷵ؿspanдϺ commit
+		std::span<std::byte> reserve(uint32_t n) noexcept
+		{
+			if (n > max_message_size()) {
+				return {};
+			}
+
+			const uint64_t total = AlignUp(sizeof(Header) + n);
+			uint64_t wpos = _wpos.load(std::memory_order_relaxed);
+			uint64_t pad;
+			for (;;)
+			{
+				const uint64_t tail = _size - (wpos & _mask);
+				pad = total > tail ? tail : 0;
+				if (wpos + pad + total - _rpos.load(std::memory_order_acquire) > _size) {
+					return {}; // full
+				}
+
+				if constexpr (MultiProducer) {
+					if (_wpos.compare_exchange_weak(wpos, wpos + pad + total,
+						std::memory_order_relaxed, std::memory_order_relaxed)) {
+						break;
+					}
+				}
+				else {
+					_wpos.store(wpos + pad + total, std::memory_order_relaxed);
+					break;
+				}
+			}
+
+			if (pad > 0) {
+				Header* padding = header_at(wpos);
+				padding->len = static_cast<uint32_t>(pad - sizeof(Header));
+				padding->flags = kPadding;
+				padding->tag.store(wpos + 1, std::memory_order_release);
+				wpos += pad;
+			}
+
+			Header* hdr = header_at(wpos);
+			hdr->len = n;
+			hdr->flags = 0;
+			hdr->tag.store((wpos + 1) | kPending, std::memory_order_relaxed);
+			return { reinterpret_cast<std::byte*>(hdr + 1), n };
+		}
+
+		//	 reserve õļ¼ʱԵļ¼ύ
+		void commit(std::span<std::byte> record) noexcept
+		{
+			Header* hdr = reinterpret_cast<Header*>(record.data()) - 1;
+			hdr->tag.store(hdr->tag.load(std::memory_order_relaxed) & ~kPending, std::memory_order_release);
+		}
+
+		//	ԤԼ + һ memcpy + ύ
+		bool write(const void* data, uint32_t n) noexcept
+		{
+			auto record = reserve(n);
+			if (record.data() == nullptr) {
+				return false;
+			}
+
+			std::memcpy(record.data(), data, n);
+			commit(record);
+			return true;
+		}
+
+		//	ȡһѷϢӣûʱؿspanϢ data ǿաsize Ϊ0 span
+		std::span<const std::byte> front() noexcept
+		{
+			uint64_t rpos = _rpos.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				Header* hdr = header_at(rpos);
+				if (hdr->tag.load(std::memory_order_acquire) != rpos + 1) {
+					return {}; // empty߶׼¼δύ
+				}
+
+				//	tag ƥУ鳤дλã¼ʱմԽ _storage ȡ
+				if (hdr->len > max_message_size()
+					|| rpos + AlignUp(sizeof(Header) + hdr->len) > _wpos.load(std::memory_order_acquire)) {
+					return {};
+				}
+
+				if (hdr->flags & kPadding) {
+					rpos = Consume(rpos, hdr);
+					continue;
+				}
+
+				return { reinterpret_cast<const std::byte*>(hdr + 1), hdr->len };
+			}
+		}
+
+		//	 front صϢͷռ
+		void pop() noexcept
+		{
+			const uint64_t rpos = _rpos.load(std::memory_order_relaxed);
+			Consume(rpos, header_at(rpos));
+		}
+
+		ByteRingBuffer(ByteRingBuffer const&) = delete;
+		ByteRingBuffer& operator=(ByteRingBuffer const&) = delete;
+		ByteRingBuffer& operator=(ByteRingBuffer&& rhs) = delete;
+
+	private:
+
+		static constexpr std::size_t kCacheLine = 64;
+		static constexpr uint64_t kAlign = 16;
+		static constexpr uint64_t kPending = 1ull << 63;
+		static constexpr uint32_t kPadding = 1;
+
+		struct Header
+		{
+			std::atomic<uint64_t> tag;
+			uint32_t len;
+			uint32_t flags;
+		};
+		static_assert(sizeof(Header) == kAlign, "record header must fill one alignment unit");
+
+		Header* header_at(uint64_t pos) const noexcept
+		{
+			return reinterpret_cast<Header*>(_storage + (pos & _mask));
+		}
+
+		//	¼ֻӶ뵥ԪͷʼͷſռǰֻÿԪͷ tag ڵ 8 ֽ
+		//	֮λ䵽ڴʱֻῴΪ0 tagǾɸ
+		uint64_t Consume(uint64_t rpos, Header* hdr) noexcept
+		{
+			const uint64_t total = AlignUp(sizeof(Header) + hdr->len);
+			hdr->tag.store(0, std::memory_order_relaxed);
+			std::byte* const base = reinterpret_cast<std::byte*>(hdr);
+			for (uint64_t off = kAlign; off < total; off += kAlign) {
+				std::memset(base + off, 0, sizeof(hdr->tag));
+			}
+			_rpos.store(rpos + total, std::memory_order_release);
+			return rpos + total;
+		}
+
+		static uint64_t AlignUp(uint64_t n) noexcept
+		{
+			return (n + (kAlign - 1)) & ~(kAlign - 1);
+		}
+
+		static uint32_t NextPowerOfTwo(uint32_t n) noexcept
+		{
+			if (n == 0) return 1;
+
+			n--;
+			n |= n >> 1;
+			n |= n >> 2;
+			n |= n >> 4;
+			n |= n >> 8;
+			n |= n >> 16;
+			return n + 1;
+		}
+
+		const uint64_t _size;
+		const uint64_t _mask;
+		std::byte* const _storage;
+
+		alignas(kCacheLine) std::atomic<uint64_t> _wpos;
+		alignas(kCacheLine) std::atomic<uint64_t> _rpos;
+	};
+
+	//	㲥λο LMAX Disruptor1дÿݱ߸һ
+	//	ÿ߳ԼĶţֻԼ߿ˮ߽׶
+	//	λڹʱԤȴãдǶԲλֵ߱ڿʼǰȫ
+	template<class T>
+	class BroadcastRingBuffer
+	{
+		static constexpr std::size_t kCacheLine = 64;
+
+	public:
+
+		class Consumer
+		{
+		public:
+
+			//	Ѿݣ max handler(const T&)ش
+			template<typename Handler>
+			uint32_t poll(Handler&& handler, uint32_t max = UINT32_MAX)
+			{
+				const uint64_t seq = _seq.load(std::memory_order_relaxed);
+				if (seq == _available) {
+					_available = barrier();
+					if (seq == _available) {
+						return 0; // empty
+					}
+				}
+
+				const uint64_t end = std::min<uint64_t>(_available, seq + max);
+				for (uint64_t i = seq; i < end; ++i) {
+					handler(static_cast<const T&>(_owner._slots[i & _owner._mask]));
+				}
+
+				_seq.store(end, std::memory_order_release);
+				return static_cast<uint32_t>(end - seq);
+			}
+
+			bool try_read(T& item)
+			{
+				return poll([&item](const T& v) { item = v; }, 1) == 1;
+			}
+
+			//	ѴҲһҪ
+			uint64_t sequence() const noexcept
+			{
+				return _seq.load(std::memory_order_acquire);
+			}
+
+			Consumer(Consumer const&) = delete;
+			Consumer& operator=(Consumer const&) = delete;
+
+		private:
+
+			friend class BroadcastRingBuffer;
+
+			Consumer(BroadcastRingBuffer& owner, std::vector<const std::atomic<uint64_t>*> gates)
+				: _owner(owner)
+				, _gates(std::move(gates))
+			{
+			}
+
+			//	ɴޣûʱߵķλãλ
+			uint64_t barrier() const noexcept
+			{
+				uint64_t available = UINT64_MAX;
+				for (const auto* gate : _gates) {
+					available = std::min(available, gate->load(std::memory_order_acquire));
+				}
+				return available;
+			}
+
+			BroadcastRingBuffer& _owner;
+			const std::vector<const std::atomic<uint64_t>*> _gates;
+
+			alignas(kCacheLine) std::atomic<uint64_t> _seq{ 0 };
+			uint64_t _available{ 0 };	//	һι۲쵽ޣ˽
+		};
+
+		explicit BroadcastRingBuffer(uint32_t capacity)
+			: _size(NextPowerOfTwo(capacity))
+			, _mask(_size - 1)
+			, _slots(new T[_size]())
+		{
+			assert(_size >= 2 && "BroadcastRingBuffer size must be at least 2");
+		}
+
+		//	ߣdepends ΪʱֱӸߣֻѴ
+		Consumer& add_consumer(std::initializer_list<const Consumer*> depends = {})
+		{
+			std::vector<const std::atomic<uint64_t>*> gates;
+			if (depends.size() == 0) {
+				gates.push_back(&_cursor);
+			}
+			for (const Consumer* dep : depends) {
+				assert(&dep->_owner == this && "dependency belongs to another BroadcastRingBuffer");
+				gates.push_back(&dep->_seq);
+			}
+
+			_consumers.emplace_back(new Consumer(*this, std::move(gates)));
+			return *_consumers.back();
+		}
+
+		uint32_t capacity() const noexcept
+		{
+			return static_cast<uint32_t>(_size);
+		}
+
+		//	һλֱд߻ûߣʱnullptrд publish
+		T* try_claim() noexcept
+		{
+			if (_next - _gating >= _size) {
+				_gating = slowest_consumer();
+				if (_next - _gating >= _size) {
+					return nullptr; // full
+				}
+			}
+
+			return &_slots[_next & _mask];
+		}
+
+		void publish() noexcept
+		{
+			_cursor.store(++_next, std::memory_order_release);
+		}
+
+		template<typename U>
+		bool write(U&& value)
+		{
+			T* slot = try_claim();
+			if (slot == nullptr) {
+				return false;
+			}
+
+			*slot = std::forward<U>(value);
+			publish();
+			return true;
+		}
+
+		BroadcastRingBuffer(BroadcastRingBuffer const&) = delete;
+		BroadcastRingBuffer& operator=(BroadcastRingBuffer const&) = delete;
+		BroadcastRingBuffer& operator=(BroadcastRingBuffer&& rhs) = delete;
+
+	private:
+
+		//	ûʱ߲Լ
+		uint64_t slowest_consumer() const noexcept
+		{
+			uint64_t slowest = _next;
+			for (const auto& consumer : _consumers) {
+				slowest = std::min(slowest, consumer->_seq.load(std::memory_order_acquire));
+			}
+			return slowest;
+		}
+
+		static uint32_t NextPowerOfTwo(uint32_t n) noexcept
+		{
+			if (n == 0) return 1;
+
+			n--;
+			n |= n >> 1;
+			n |= n >> 2;
+			n |= n >> 4;
+			n |= n >> 8;
+			n |= n >> 16;
+			return n + 1;
+		}
+
+		const uint64_t _size;
+		const uint64_t _mask;
+		const std::unique_ptr<T[]> _slots;
+		std::vector<std::unique_ptr<Consumer>> _consumers;
+
+		alignas(kCacheLine) std::atomic<uint64_t> _cursor{ 0 };	//	ѷ
+		uint64_t _next{ 0 };		//	˽Уһ
+		uint64_t _gating{ 0 };		//	˽Уһι۲쵽λ
+	};
+
+	//	λң/׷ݣдʱɵݣԶȴ
+	//	ÿλţseqlock߸ݺ󸴲ţֱ overrun
+	//	ߣĶ߸Գ ReaderT ƽ
+	template<class T>
+	class LossyRingBuffer
+	{
+		static constexpr std::size_t kCacheLine = 64;
+
+	public:
+
+		class Reader
+		{
+		public:
+
+			//	ӵǰȻݿʼȡ
+			explicit Reader(const LossyRingBuffer& ring) noexcept
+				: _ring(ring)
+			{
+				const uint64_t wpos = ring._wpos.load(std::memory_order_acquire);
+				_rpos = wpos > ring._size ? wpos - ring._size : 0;
+			}
+
+			bool read(T& item) noexcept
+			{
+				for (;;)
+				{
+					const uint64_t wpos = _ring._wpos.load(std::memory_order_acquire);
+					if (_rpos == wpos) {
+						return false; // empty
+					}
+
+					if (wpos - _rpos > _ring._size) {
+						//	󳬹һȦɵȻ
+						_overruns += wpos - _ring._size - _rpos;
+						_rpos = wpos - _ring._size;
+					}
+
+					const Slot& slot = _ring._slots[_rpos & _ring._mask];
+					const uint64_t expect = Stamp(_rpos);
+					if (slot.seq.load(std::memory_order_acquire) != expect) {
+						//	ȡڼѾʼλ
+						++_overruns;
+						++_rpos;
+						continue;
+					}
+
+					std::memcpy(&item, slot.data, sizeof(T));
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if (slot.seq.load(std::memory_order_relaxed) != expect) {
+						++_overruns;
+						++_rpos;
+						continue;
+					}
+
+					++_rpos;
+					return true;
+				}
+			}
+
+			//	Ƕûж
+			uint64_t overruns() const noexcept
+			{
+				return _overruns;
+			}
+
+		private:
+
+			const LossyRingBuffer& _ring;
+			uint64_t _rpos{ 0 };
+			uint64_t _overruns{ 0 };
+		};
+
+		explicit LossyRingBuffer(uint32_t capacity)
+			: _size(NextPowerOfTwo(capacity))
+			, _mask(_size - 1)
+			, _slots(new Slot[_size])
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "LossyRingBuffer requires a trivially copyable type");
+			assert(_size >= 2 && "LossyRingBuffer size must be at least 2");
+		}
+
+		uint32_t capacity() const noexcept
+		{
+			return static_cast<uint32_t>(_size);
+		}
+
+		//	д
+		uint64_t written() const noexcept
+		{
+			return _wpos.load(std::memory_order_acquire);
+		}
+
+		//	дӲʧܣҲӲȴ
+		void write(const T& item) noexcept
+		{
+			const uint64_t wpos = _wpos.load(std::memory_order_relaxed);
+			Slot& slot = _slots[wpos & _mask];
+
+			//	űʾд߿ζȡ
+			slot.seq.store(Stamp(wpos) - 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			std::memcpy(slot.data, &item, sizeof(T));
+			slot.seq.store(Stamp(wpos), std::memory_order_release);
+			_wpos.store(wpos + 1, std::memory_order_release);
+		}
+
+		LossyRingBuffer(LossyRingBuffer const&) = delete;
+		LossyRingBuffer& operator=(LossyRingBuffer const&) = delete;
+		LossyRingBuffer& operator=(LossyRingBuffer&& rhs) = delete;
+
+	private:
+
+		struct Slot
+		{
+			std::atomic<uint64_t> seq{ 0 };
+			alignas(T) std::byte data[sizeof(T)];
+		};
+
+		//	λ pos дĲλţʼΪżҲΪ0
+		static uint64_t Stamp(uint64_t pos) noexcept
+		{
+			return 2 * pos + 2;
+		}
+
+		static uint32_t NextPowerOfTwo(uint32_t n) noexcept
+		{
+			if (n == 0) return 1;
+
+			n--;
+			n |= n >> 1;
+			n |= n >> 2;
+			n |= n >> 4;
+			n |= n >> 8;
+			n |= n >> 16;
+			return n + 1;
+		}
+
+		const uint64_t _size;
+		const uint64_t _mask;
+		const std::unique_ptr<Slot[]> _slots;
+
+		alignas(kCacheLine) std::atomic<uint64_t> _wpos{ 0 };
+	};
+
+	//	̹ڴ滷λ1д1ͬһϵ̣
+	//	ͷ洢λڴУֻλòָ룬ӳ䵽ַͬҲܹ
+	//	ÿһʱǼǽIDʹ(generation)Զ˿ɾݴ˼
+	//	T ƽƣдڷ _wpos ǰɣһ˱°дԪ
+	template<class T>
+	class ShmSPSCRingBuffer
+	{
+	public:
+
+		enum class Role : uint8_t
+		{
+			Producer,
+			Consumer,
+		};
+
+		//	׸߰ capacity ڴ棬У鲼ֺ
+		ShmSPSCRingBuffer(const char* name, uint32_t capacity, Role role)
+			: _role(role)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "ShmSPSCRingBuffer requires a trivially copyable type");
+			static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory requires address-free atomics");
+
+			const uint64_t size = NextPowerOfTwo(capacity);
+			assert(size >= 2 && "ShmSPSCRingBuffer size must be at least 2");
+			_bytes = sizeof(ShmHeader) + sizeof(T) * size;
+			const bool created = Map(name);
+			_header = static_cast<ShmHeader*>(_base);
+
+			if (created) {
+				new (_header) ShmHeader();
+				_header->elem_size = sizeof(T);
+				_header->size = size;
+				_header->magic.store(kMagic, std::memory_order_release);
+			}
+			else {
+				//	ȴɳʼ
+				const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+				while (_header->magic.load(std::memory_order_acquire) != kMagic)
+				{
+					if (std::chrono::steady_clock::now() > deadline) {
+						Unmap();
+						throw std::runtime_error("ShmSPSCRingBuffer header was never initialized");
+					}
+					std::this_thread::yield();
+				}
+
+				if (_header->elem_size != sizeof(T) || _header->size != size) {
+					Unmap();
+					throw std::runtime_error("ShmSPSCRingBuffer layout mismatch");
+				}
+			}
+
+			_size = _header->size;
+			_mask = _size - 1;
+			_storage = reinterpret_cast<T*>(static_cast<std::byte*>(_base) + sizeof(ShmHeader));
+
+			//	CAS ǼǽɫͬʱλʱֻһܳɹͬһظͬһɫҲᱻܾ
+			Peer& self = role == Role::Producer ? _header->producer : _header->consumer;
+			uint64_t pid = self.pid.load(std::memory_order_acquire);
+			for (;;)
+			{
+				if (pid != 0 && (pid == CurrentPid() || ProcessAlive(pid))) {
+					Unmap();
+					throw std::runtime_error("ShmSPSCRingBuffer role is already attached by a live process");
+				}
+
+				if (self.pid.compare_exchange_strong(pid, CurrentPid(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+					break;
+				}
+			}
+			self.generation.fetch_add(1, std::memory_order_acq_rel);
+			_rposCache = _header->rpos.load(std::memory_order_acquire);
+			_wposCache = _header->wpos.load(std::memory_order_acquire);
+		}
+
+		//	ϿʱǼǣɾڴ棻Ҫʱ Unlink
+		~ShmSPSCRingBuffer()
+		{
+			Peer& self = _role == Role::Producer ? _header->producer : _header->consumer;
+			self.pid.store(0, std::memory_order_release);
+			Unmap();
+		}
+
+		//	ɾڴ棨POSIXӳĽ̲Ӱ죻Windows һرʱԶͷ
+		static void Unlink(const char* name) noexcept
+		{
+#ifndef _WIN32
+			::shm_unlink(ShmName(name).c_str());
+#else
+			(void)name;
+#endif
+		}
+
+		bool empty() const noexcept
+		{
+			return _header->rpos.load(std::memory_order_acquire) == _header->wpos.load(std::memory_order_acquire);
+		}
+
+		uint32_t capacity() const noexcept
+		{
+			return static_cast<uint32_t>(_size - 1);
+		}
+
+		bool write(const T& item) noexcept
+		{
+			const uint64_t wpos = _header->wpos.load(std::memory_order_relaxed);
+			if (wpos + 1 - _rposCache >= _size) {
+				_rposCache = _header->rpos.load(std::memory_order_acquire);
+				if (wpos + 1 - _rposCache >= _size) {
+					return false; // full
+				}
+			}
+
+			std::memcpy(&_storage[wpos & _mask], &item, sizeof(T));
+			_header->wpos.store(wpos + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool read(T& item) noexcept
+		{
+			const uint64_t rpos = _header->rpos.load(std::memory_order_relaxed);
+			if (rpos == _wposCache) {
+				_wposCache = _header->wpos.load(std::memory_order_acquire);
+				if (rpos == _wposCache) {
+					return false; // empty
+				}
+			}
+
+			std::memcpy(&item, &_storage[rpos & _mask], sizeof(T));
+			_header->rpos.store(rpos + 1, std::memory_order_release);
+			return true;
+		}
+
+		//	ԶǷȻҽ̴ĽǼǣɽ̴֣ⷢ
+		bool peer_alive() const noexcept
+		{
+			const Peer& peer = _role == Role::Producer ? _header->consumer : _header->producer;
+			const uint64_t pid = peer.pid.load(std::memory_order_acquire);
+			return pid != 0 && ProcessAlive(pid);
+		}
+
+		//	Զ˵Ӵ仯˵Զ
+		uint64_t peer_generation() const noexcept
+		{
+			const Peer& peer = _role == Role::Producer ? _header->consumer : _header->producer;
+			return peer.generation.load(std::memory_order_acquire);
+		}
+
+		ShmSPSCRingBuffer(ShmSPSCRingBuffer const&) = delete;
+		ShmSPSCRingBuffer& operator=(ShmSPSCRingBuffer const&) = delete;
+		ShmSPSCRingBuffer& operator=(ShmSPSCRingBuffer&& rhs) = delete;
+
+	private:
+
+		static constexpr std::size_t kCacheLine = 64;
+		static constexpr uint64_t kMagic = 0x5053435348524E47ull;	//	"GNRHSCSP"
+
+		struct Peer
+		{
+			std::atomic<uint64_t> pid{ 0 };
+			std::atomic<uint64_t> generation{ 0 };
+		};
+
+		//	ڴͷֶΰд뷽ֻУ֮α
+		struct ShmHeader
+		{
+			std::atomic<uint64_t> magic{ 0 };
+			uint64_t elem_size{ 0 };
+			uint64_t size{ 0 };
+
+			alignas(kCacheLine) std::atomic<uint64_t> wpos{ 0 };
+			alignas(kCacheLine) std::atomic<uint64_t> rpos{ 0 };
+			alignas(kCacheLine) Peer producer;
+			alignas(kCacheLine) Peer consumer;
+		};
+
+		static uint64_t NextPowerOfTwo(uint64_t n) noexcept
+		{
+			if (n == 0) return 1;
+
+			n--;
+			n |= n >> 1;
+			n |= n >> 2;
+			n |= n >> 4;
+			n |= n >> 8;
+			n |= n >> 16;
+			n |= n >> 32;
+			return n + 1;
+		}
+
+		static uint64_t CurrentPid() noexcept
+		{
+#ifdef _WIN32
+			return ::GetCurrentProcessId();
+#else
+			return static_cast<uint64_t>(::getpid());
+#endif
+		}
+
+		static bool ProcessAlive(uint64_t pid) noexcept
+		{
+#ifdef _WIN32
+			HANDLE h = ::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+			if (h == nullptr) {
+				return ::GetLastError() == ERROR_ACCESS_DENIED;
+			}
+
+			DWORD code = 0;
+			const BOOL ok = ::GetExitCodeProcess(h, &code);
+			::CloseHandle(h);
+			return ok && code == STILL_ACTIVE;
+#else
+			return ::kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+#endif
+		}
+
+#ifndef _WIN32
+		static std::string ShmName(const char* name)
+		{
+			return name[0] == '/' ? std::string(name) : std::string("/") + name;
+		}
+#endif
+
+		//	ӳڴ棬Ƿɱ˴
+		bool Map(const char* name)
+		{
+#ifdef _WIN32
+			_mapping = ::CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+				static_cast<DWORD>(_bytes >> 32), static_cast<DWORD>(_bytes), name);
+			if (_mapping == nullptr) {
+				throw std::runtime_error("CreateFileMapping failed");
+			}
+
+			const bool created = ::GetLastError() != ERROR_ALREADY_EXISTS;
+			_base = ::MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, _bytes);
+			if (_base == nullptr) {
+				::CloseHandle(_mapping);
+				throw std::runtime_error("MapViewOfFile failed");
+			}
+			return created;
+#else
+			const std::string shm_name = ShmName(name);
+			bool created = true;
+			int fd = ::shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+			if (fd < 0 && errno == EEXIST) {
+				created = false;
+				fd = ::shm_open(shm_name.c_str(), O_RDWR, 0600);
+			}
+			if (fd < 0) {
+				throw std::runtime_error("shm_open failed");
+			}
+
+			if (created) {
+				if (::ftruncate(fd, static_cast<off_t>(_bytes)) != 0) {
+					::close(fd);
+					::shm_unlink(shm_name.c_str());
+					throw std::runtime_error("ftruncate failed");
+				}
+			}
+			else {
+				//	߿ܻûüôС
+				struct stat st {};
+				const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+				while (::fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_size) < _bytes)
+				{
+					if (std::chrono::steady_clock::now() > deadline) {
+						::close(fd);
+						throw std::runtime_error("ShmSPSCRingBuffer layout mismatch");
+					}
+					std::this_thread::yield();
+				}
+			}
+
+			_base = ::mmap(nullptr, _bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			::close(fd);
+			if (_base == MAP_FAILED) {
+				throw std::runtime_error("mmap failed");
+			}
+			return created;
+#endif
+		}
+
+		void Unmap() noexcept
+		{
+#ifdef _WIN32
+			::UnmapViewOfFile(_base);
+			::CloseHandle(_mapping);
+#else
+			::munmap(_base, _bytes);
+#endif
+		}
+
+		//	˽в
+		const Role _role;
+		uint64_t _bytes{ 0 };
+		void* _base{ nullptr };
+#ifdef _WIN32
+		HANDLE _mapping{ nullptr };
+#endif
+		ShmHeader* _header{ nullptr };
+		T* _storage{ nullptr };
+		uint64_t _size{ 0 };
+		uint64_t _mask{ 0 };
+
+		alignas(kCacheLine) uint64_t _rposCache{ 0 };	//	˽
+		alignas(kCacheLine) uint64_t _wposCache{ 0 };	//	˽
+	};
+
+	struct TestData
+	{
+		int index;
+		uint32_t data;
+		char url[32];
+		void* ptr;
+
+		TestData()
+			: index(0)
+			, data(0)
+			, ptr(nullptr)
+		{
+			std::memset(url, 0, sizeof(url));
+			//std::print("base construct.\n");
+		}
+
+		explicit TestData(int idx, uint32_t d, const char* u, void* p) noexcept
+			: index(idx)
+			, data(d)
+			, ptr(p)
+		{
+			std::memcpy(url, u, sizeof(url) - 1);
+			//std::print("construct TestData index : {}.\n", index);
+		}
+
+		~TestData() noexcept
+		{
+			//std::print("destruct ~TestData index : {}.\n", index);
+		}
+
+		TestData(TestData const&) = delete;
+		TestData& operator=(TestData const&) = delete;
+
+		TestData(TestData&& o)
+		{
+			index = o.index;
+			data = o.data;
+			ptr = o.ptr;
+			std::memcpy(url, o.url, sizeof(url) - 1);
+			//std::print("move construct index : {}.\n", index);
+		}
+
+		TestData& operator=(TestData&& o)
+		{
+			index = o.index;
+			data = o.data;
+			ptr = o.ptr;
+			std::memcpy(url, o.url, sizeof(url) - 1);
+			return *this;
+			//std::print("move operator= index : {}.\n", index);
+		}
+	};
+	//	SPSC ׼߸һ̣߳ count  uint64_t
+	template<typename Traits>
+	static void SPSCThroughput(const char* name, uint64_t count)
+	{
+		SPSCRingBuffer<uint64_t, Traits> buffer(4096);
+		uint64_t sum = 0;
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+		{
+			ThreadGuardJoin producer(std::thread([&buffer, count]() {
+				for (uint64_t i = 0; i < count;)
+				{
+					if (buffer.write(i)) {
+						++i;
+					}
+				}
+				}));
+
+			ThreadGuardJoin consumer(std::thread([&buffer, &sum, count]() {
+				uint64_t v;
+				for (uint64_t i = 0; i < count;)
+				{
+					if (buffer.read(v)) {
+						sum += v;
+						++i;
+					}
+				}
+				}));
+		}
+		auto end_time = std::chrono::high_resolution_clock::now();
+
+		const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+		assert(sum == count * (count - 1) / 2);
+		std::print("spsc {} {} ops, use {}ms, {:.2f} Mops/s.\n", name, count, ms,
+			ms > 0 ? static_cast<double>(count) / ms / 1000.0 : 0.0);
+	}
+
+	//	׼push 豣֤дɹpop ʧܷfalse
+	template<typename Push, typename Pop>
+	static void MPMCThroughput(const char* name, uint32_t producers, uint32_t consumers, uint64_t per_producer,
+		Push&& push, Pop&& pop)
+	{
+		const uint64_t total = producers * per_producer;
+		std::atomic<uint64_t> read_count{ 0 };
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+		{
+			std::vector<ThreadGuardJoin> threads;
+			threads.reserve(producers + consumers);
+			for (uint32_t p = 0; p < producers; ++p)
+			{
+				threads.emplace_back(std::thread([&push, per_producer]() {
+					for (uint64_t i = 0; i < per_producer; ++i) {
+						push(i);
+					}
+					}));
+			}
+
+			for (uint32_t c = 0; c < consumers; ++c)
+			{
+				threads.emplace_back(std::thread([&pop, &read_count, total]() {
+					uint64_t v;
+					while (read_count.load(std::memory_order_relaxed) < total)
+					{
+						if (pop(v)) {
+							read_count.fetch_add(1, std::memory_order_relaxed);
+						}
+					}
+					}));
+			}
+		}
+		auto end_time = std::chrono::high_resolution_clock::now();
+
+		const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+		std::print("{} {}P{}C {} ops, use {}ms, {:.2f} Mops/s.\n", name, producers, consumers, total, ms,
+			ms > 0 ? static_cast<double>(total) / ms / 1000.0 : 0.0);
+	}
+
+	//	MPMCSlotRingBuffer ѹԣУܺԼÿߵڵӽ±FIFO
+	static bool MPMCSlotStress(uint32_t producers, uint32_t consumers, uint32_t per_producer, uint32_t capacity)
+	{
+		MPMCSlotRingBuffer<uint64_t> buffer(capacity);
+		std::atomic<uint64_t> read_count{ 0 };
+		std::atomic<uint64_t> read_sum{ 0 };
+		std::atomic<bool> ordered{ true };
+		const uint64_t total = static_cast<uint64_t>(producers) * per_producer;
+
+		{
+			std::vector<ThreadGuardJoin> threads;
+			threads.reserve(producers + consumers);
+			for (uint32_t p = 0; p < producers; ++p)
+			{
+				threads.emplace_back(std::thread([&buffer, p, per_producer]() {
+					for (uint32_t i = 0; i < per_producer;)
+					{
+						if (buffer.try_write((static_cast<uint64_t>(p) << 32) | i)) {
+							++i;
+						}
+						else {
+							std::this_thread::yield();
+						}
+					}
+					}));
+			}
+
+			for (uint32_t c = 0; c < consumers; ++c)
+			{
+				threads.emplace_back(std::thread([&, producers]() {
+					std::vector<int64_t> last(producers, -1);
+					uint64_t v;
+					while (read_count.load(std::memory_order_relaxed) < total)
+					{
+						if (!buffer.try_read(v)) {
+							std::this_thread::yield();
+							continue;
+						}
+
+						const uint32_t p = static_cast<uint32_t>(v >> 32);
+						const int64_t seq = static_cast<int64_t>(v & 0xffffffff);
+						if (p >= producers || seq <= last[p]) {
+							ordered.store(false);
+						}
+						else {
+							last[p] = seq;
+						}
+
+						read_sum.fetch_add(v & 0xffffffff, std::memory_order_relaxed);
+						read_count.fetch_add(1, std::memory_order_relaxed);
+					}
+					}));
+			}
+		}
+
+		const uint64_t expect_sum = static_cast<uint64_t>(producers) * per_producer * (per_producer - 1) / 2;
+		return ordered.load() && read_count.load() == total && read_sum.load() == expect_sum && buffer.empty();
+	}
+
+	//	䳤Ϣԣÿд볤ű仯Ϣ (, ) ɣֽУ
+	template<bool MultiProducer>
+	static bool ByteRingTest(uint32_t producers, uint32_t per_producer, uint32_t capacity)
+	{
+		struct Frame
+		{
+			uint32_t producer;
+			uint32_t seq;
+		};
+
+		ByteRingBuffer<MultiProducer> buffer(capacity);
+		const uint32_t max_len = std::min<uint32_t>(300, buffer.max_message_size());
+		bool ok = true;
+
+		{
+			std::vector<ThreadGuardJoin> threads;
+			for (uint32_t p = 0; p < producers; ++p)
+			{
+				threads.emplace_back(std::thread([&buffer, p, per_producer, max_len]() {
+					for (uint32_t i = 0; i < per_producer;)
+					{
+						const uint32_t len = sizeof(Frame) + (i * 7 + p) % (max_len - sizeof(Frame));
+						auto record = buffer.reserve(len);
+						if (record.data() == nullptr) {
+							std::this_thread::yield();
+							continue;
+						}
+
+						Frame frame{ p, i };
+						std::memcpy(record.data(), &frame, sizeof(frame));
+						for (uint32_t b = sizeof(Frame); b < len; ++b) {
+							record[b] = static_cast<std::byte>(p + i + b);
+						}
+						buffer.commit(record);
+						++i;
+					}
+					}));
+			}
+
+			threads.emplace_back(std::thread([&buffer, &ok, producers, per_producer, max_len]() {
+				std::vector<uint32_t> next(producers, 0);
+				for (uint64_t n = 0; n < static_cast<uint64_t>(producers) * per_producer;)
+				{
+					auto msg = buffer.front();
+					if (msg.data() == nullptr) {
+						std::this_thread::yield();
+						continue;
+					}
+
+					Frame frame;
+					std::memcpy(&frame, msg.data(), sizeof(frame));
+					const uint32_t p = frame.producer;
+					const uint32_t i = frame.seq;
+					if (p >= producers || i != next[p]
+						|| msg.size() != sizeof(Frame) + (i * 7 + p) % (max_len - sizeof(Frame))) {
+						ok = false;
+					}
+					else {
+						for (uint32_t b = sizeof(Frame); b < msg.size(); ++b) {
+							if (msg[b] != static_cast<std::byte>(p + i + b)) {
+								ok = false;
+								break;
+							}
+						}
+						++next[p];
+					}
+
+					buffer.pop();
+					++n;
+				}
+				}));
+		}
+
+		return ok && buffer.empty();
+	}
 
-		//	ʵĶдλ
-		alignas(kCacheLine) std::atomic<uint64_t> _wpos;
-		alignas(kCacheLine) std::atomic<uint64_t> _rpos;
+	//	زԣصÿ 16 ֽڵԪ롰һָλõ tagͳ lenģ⹹
+	//	ÿдһٳӣ֮󻺳Ϊգfront 뷵ؿspan
+	static bool ByteRingStaleTest(uint32_t capacity, uint32_t rounds)
+	{
+		ByteRingBuffer<false> buffer(capacity);
+		const uint64_t size = buffer.capacity();
+		uint64_t wpos = 0;		//	 reserve Ĺдλ
+		for (uint32_t r = 0; r < rounds; ++r)
+		{
+			const uint32_t len = 16 + (r * 24) % 200;
+			const uint64_t total = (16 + len + 15) & ~uint64_t(15);
+			if (total > size - (wpos % size)) {
+				wpos += size - (wpos % size);	//	¼
+			}
 
-		//	ԤԼԱ¼ԤԼȥλ
-		//  дԤԼܳʵʿɶλãԤԼܳʵʿдλ
-		alignas(kCacheLine) std::atomic<uint64_t> _wpre;
-		alignas(kCacheLine) std::atomic<uint64_t> _rpre;
+			auto record = buffer.reserve(len);
+			if (record.data() == nullptr) {
+				return false;
+			}
+			for (uint32_t unit = 0; unit + 16 <= len; unit += 16) {
+				const uint64_t tag = wpos + 16 + unit + size + 1;
+				const uint64_t fake = 0xFFFFFF00u;		//	len = 0xFFFFFF00flags = 0
+				std::memcpy(record.data() + unit, &tag, sizeof(tag));
+				std::memcpy(record.data() + unit + 8, &fake, sizeof(fake));
+			}
+			buffer.commit(record);
+			wpos += total;
 
-		const uint64_t _size;
-		const uint64_t _mask;
-		T* const _storage;
-	};
+			auto msg = buffer.front();
+			if (msg.data() == nullptr || msg.size() != len) {
+				return false;
+			}
+			buffer.pop();
 
-	struct TestData
-	{
-		int index;
-		uint32_t data;
-		char url[32];
-		void* ptr;
+			if (!buffer.empty() || buffer.front().data() != nullptr) {
+				return false;
+			}
+		}
+		return true;
+	}
 
-		TestData()
-			: index(0)
-			, data(0)
-			, ptr(nullptr)
-		{
-			std::memset(url, 0, sizeof(url));
-			//std::print("base construct.\n");
+	//	Ʋԣдλô start ʼ index_type 㣬ǵ//㿽ӿڡ/жϺͿ̴߳
+	template<typename Traits>
+	static bool WrapAroundTest(typename SPSCRingBuffer<uint64_t, Traits>::index_type start, uint64_t count)
+	{
+		SPSCRingBuffer<uint64_t, Traits> buffer(64, start);
+		bool ok = buffer.empty() && !buffer.full();
+
+		uint64_t next_write = 0;
+		uint64_t next_read = 0;
+		uint64_t item = 0;
+		while (buffer.write(next_write)) {
+			++next_write;
 		}
+		ok = ok && next_write == buffer.capacity() && buffer.full();
 
-		explicit TestData(int idx, uint32_t d, const char* u, void* p) noexcept
-			: index(idx)
-			, data(d)
-			, ptr(p)
-		{
-			std::memcpy(url, u, sizeof(url) - 1);
-			//std::print("construct TestData index : {}.\n", index);
+		while (buffer.read(item)) {
+			ok = ok && item == next_read++;
 		}
+		ok = ok && next_read == next_write && buffer.empty() && !buffer.full();
 
-		~TestData() noexcept
+		std::vector<uint64_t> batch(48);
+		for (int round = 0; round < 8; ++round)
 		{
-			//std::print("destruct ~TestData index : {}.\n", index);
-		}
+			for (auto& value : batch) {
+				value = next_write++;
+			}
+			ok = ok && buffer.write_bulk(batch.begin(), batch.end()) == batch.size();
 
-		TestData(TestData const&) = delete;
-		TestData& operator=(TestData const&) = delete;
+			auto slots = buffer.claim_write_bulk(16);
+			for (auto& slot : slots) {
+				new (&slot) uint64_t(next_write++);
+			}
+			buffer.commit_write(slots.size());
 
-		TestData(TestData&& o)
-		{
-			index = o.index;
-			data = o.data;
-			ptr = o.ptr;
-			std::memcpy(url, o.url, sizeof(url) - 1);
-			//std::print("move construct index : {}.\n", index);
+			const auto num = buffer.read_bulk(batch.begin(), 32);
+			for (std::size_t i = 0; i < num; ++i) {
+				ok = ok && batch[i] == next_read++;
+			}
+			while (const uint64_t* front = buffer.front()) {
+				ok = ok && *front == next_read++;
+				buffer.pop();
+			}
 		}
+		ok = ok && next_read == next_write && buffer.empty();
 
-		TestData& operator=(TestData&& o)
 		{
-			index = o.index;
-			data = o.data;
-			ptr = o.ptr;
-			std::memcpy(url, o.url, sizeof(url) - 1);
-			return *this;
-			//std::print("move operator= index : {}.\n", index);
+			ThreadGuardJoin producer(std::thread([&buffer, next_write, count]() {
+				for (uint64_t i = next_write; i < next_write + count;)
+				{
+					if (buffer.write(i)) {
+						++i;
+					}
+				}
+				}));
+
+			for (const uint64_t end = next_read + count; next_read < end;)
+			{
+				if (buffer.read(item)) {
+					ok = ok && item == next_read++;
+				}
+			}
 		}
-	};
+
+		return ok && buffer.empty();
+	}
+
 	void Test() override
 	{
 		std::print(" ===== RingBuffer Bgein =====\n");
@@ -465,6 +2600,541 @@ public:
 				std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
 		}
 
+		{
+			//	ԷλǰԱ
+			constexpr uint64_t bench_count = 10'000'000;
+			SPSCThroughput<UncachedTraits>("uncached index", bench_count);
+			SPSCThroughput<DefultTraits>("cached index", bench_count);
+		}
+
+		{
+			//	㿽 claim/commit  write/read ԱȣݰԽԽ
+			struct Packet
+			{
+				uint32_t seq;
+				uint32_t len;
+				char payload[1024 - 8];
+			};
+
+			SPSCRingBuffer<Packet> buffer(1024);
+			constexpr uint32_t test_count = 262144;
+
+			auto start_time = std::chrono::high_resolution_clock::now();
+			{
+				ThreadGuardJoin producer(std::thread([&buffer]() {
+					Packet pkt{};
+					for (uint32_t i = 0; i < test_count;)
+					{
+						pkt.seq = i;
+						pkt.len = sizeof(pkt.payload);
+						std::memset(pkt.payload, static_cast<int>(i), sizeof(pkt.payload));
+						if (buffer.write(pkt)) {
+							++i;
+						}
+					}
+					}));
+
+				ThreadGuardJoin consumer(std::thread([&buffer]() {
+					Packet pkt{};
+					for (uint32_t i = 0; i < test_count;)
+					{
+						if (buffer.read(pkt)) {
+							assert(pkt.seq == i);
+							++i;
+						}
+					}
+					}));
+			}
+			auto end_time = std::chrono::high_resolution_clock::now();
+			std::print("spsc write/read {} packets of {} bytes, use {}ms.\n", test_count, sizeof(Packet),
+				std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+
+			start_time = std::chrono::high_resolution_clock::now();
+			{
+				ThreadGuardJoin producer(std::thread([&buffer]() {
+					for (uint32_t i = 0; i < test_count;)
+					{
+						auto slots = buffer.claim_write_bulk(test_count - i);
+						for (auto& pkt : slots)
+						{
+							Packet* p = new (&pkt) Packet;
+							p->seq = i++;
+							p->len = sizeof(p->payload);
+							std::memset(p->payload, static_cast<int>(p->seq), sizeof(p->payload));
+						}
+						if (!slots.empty()) {
+							buffer.commit_write(static_cast<uint32_t>(slots.size()));
+						}
+					}
+					}));
+
+				ThreadGuardJoin consumer(std::thread([&buffer]() {
+					for (uint32_t i = 0; i < test_count;)
+					{
+						if (const Packet* pkt = buffer.front()) {
+							assert(pkt->seq == i);
+							buffer.pop();
+							++i;
+						}
+					}
+					}));
+			}
+			end_time = std::chrono::high_resolution_clock::now();
+			std::print("spsc claim/commit {} packets of {} bytes, use {}ms.\n", test_count, sizeof(Packet),
+				std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+		}
+
+		{
+			//	MPMC дÿֻһԭԤԼ
+			MPMCRingBuffer<uint64_t> buffer(4096);
+			constexpr uint32_t test_thread_count = 4;
+			constexpr uint32_t batch = 64;
+			constexpr uint32_t batches = 4096;
+			constexpr uint64_t test_total = static_cast<uint64_t>(test_thread_count) * batch * batches;
+			std::atomic<uint64_t> read_count{ 0 };
+			std::atomic<uint64_t> read_sum{ 0 };
+
+			auto start_time = std::chrono::high_resolution_clock::now();
+			{
+				std::vector<ThreadGuardJoin> threads;
+				for (uint32_t t = 0; t < test_thread_count; ++t)
+				{
+					threads.emplace_back(std::thread([&buffer]() {
+						std::vector<uint64_t> vecIn(batch);
+						for (uint32_t b = 0; b < batches; ++b)
+						{
+							for (uint32_t i = 0; i < batch; ++i) {
+								vecIn[i] = b * batch + i;
+							}
+
+							buffer.write_bulk(vecIn.begin(), vecIn.end());
+						}
+						}));
+				}
+
+				for (uint32_t t = 0; t < test_thread_count; ++t)
+				{
+					threads.emplace_back(std::thread([&]() {
+						std::vector<uint64_t> vecOut(batch);
+						while (read_count.load(std::memory_order_relaxed) < test_total)
+						{
+							const uint32_t num = buffer.read_bulk(vecOut.begin(), batch);
+							for (uint32_t i = 0; i < num; ++i) {
+								read_sum.fetch_add(vecOut[i], std::memory_order_relaxed);
+							}
+							read_count.fetch_add(num, std::memory_order_relaxed);
+						}
+						}));
+				}
+			}
+			auto end_time = std::chrono::high_resolution_clock::now();
+
+			const uint64_t per_thread = static_cast<uint64_t>(batch) * batches;
+			const bool ok = read_count.load() == test_total
+				&& read_sum.load() == test_thread_count * (per_thread * (per_thread - 1) / 2);
+			std::print("mpmc ringbuffer bulk test {} count, batch {}, {}, use {}ms.\n", test_total, batch,
+				ok ? "passed" : "FAILED",
+				std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+		}
+
+		{
+			//	д볬ʱֶΣ߱߶ڳռ
+			MPMCRingBuffer<uint64_t> buffer(64);
+			std::vector<uint64_t> vecIn(1000);
+			for (uint64_t i = 0; i < vecIn.size(); ++i) {
+				vecIn[i] = i;
+			}
+
+			bool write_ok = false;
+			uint64_t read_count = 0;
+			uint64_t read_sum = 0;
+			{
+				std::vector<ThreadGuardJoin> threads;
+				threads.emplace_back(std::thread([&]() {
+					write_ok = buffer.write_bulk(vecIn.begin(), vecIn.end()) == vecIn.size();
+					}));
+				threads.emplace_back(std::thread([&]() {
+					std::vector<uint64_t> vecOut(16);
+					while (read_count < vecIn.size())
+					{
+						const uint32_t num = buffer.read_bulk(vecOut.begin(), 16);
+						for (uint32_t i = 0; i < num; ++i) {
+							read_sum += vecOut[i];
+						}
+						read_count += num;
+					}
+					}));
+			}
+
+			const bool ok = write_ok && read_sum == vecIn.size() * (vecIn.size() - 1) / 2;
+			std::print("mpmc ringbuffer oversized bulk write {} > capacity {}, {}.\n", vecIn.size(), 64, ok ? "passed" : "FAILED");
+		}
+
+		{
+			//	per-slot sequence MPMCСŴ//ƻصĸֽ
+			const bool ok = MPMCSlotStress(4, 4, 200000, 8)
+				&& MPMCSlotStress(8, 2, 100000, 64)
+				&& MPMCSlotStress(2, 8, 100000, 1024);
+			std::print("mpmc slot ringbuffer stress test {}.\n", ok ? "passed" : "FAILED");
+
+			constexpr uint64_t per_producer = 1'000'000;
+			{
+				//	ʵֶߴԤԼֻõ߶Ա
+				//	write ˻ḲδݣõԪص write_bulk ȶڳռ䣬һбѹ
+				MPMCRingBuffer<uint64_t> ticket_buffer(4096);
+				MPMCSlotRingBuffer<uint64_t> slot_buffer(4096);
+				moodycamel::ConcurrentQueue<uint64_t> con_que;
+				MPMCThroughput("MPMCRingBuffer     ", 4, 1, per_producer,
+					[&](uint64_t v) { ticket_buffer.write_bulk(&v, 1u); },
+					[&](uint64_t& v) { return ticket_buffer.read(v); });
+				MPMCThroughput("MPMCSlotRingBuffer ", 4, 1, per_producer,
+					[&](uint64_t v) { while (!slot_buffer.try_write(v)) asm_volatile_pause(); },
+					[&](uint64_t& v) { return slot_buffer.try_read(v); });
+				MPMCThroughput("ConcurrentQueue    ", 4, 1, per_producer,
+					[&](uint64_t v) { con_que.enqueue(v); },
+					[&](uint64_t& v) { return con_que.try_dequeue(v); });
+			}
+
+			{
+				MPMCSlotRingBuffer<uint64_t> slot_buffer(4096);
+				moodycamel::ConcurrentQueue<uint64_t> con_que;
+				MPMCThroughput("MPMCSlotRingBuffer ", 4, 4, per_producer,
+					[&](uint64_t v) { while (!slot_buffer.try_write(v)) asm_volatile_pause(); },
+					[&](uint64_t& v) { return slot_buffer.try_read(v); });
+				MPMCThroughput("ConcurrentQueue    ", 4, 4, per_producer,
+					[&](uint64_t v) { con_que.enqueue(v); },
+					[&](uint64_t& v) { return con_que.try_dequeue(v); });
+			}
+		}
+
+		{
+			//	䳤֡ϢSPSC  MPSC
+			auto start_time = std::chrono::high_resolution_clock::now();
+			const bool ok = ByteRingTest<false>(1, 200000, 4096) && ByteRingTest<true>(4, 50000, 4096) && ByteRingStaleTest(512, 10000);
+			auto end_time = std::chrono::high_resolution_clock::now();
+			std::print("byte ringbuffer framed message test {}, use {}ms.\n", ok ? "passed" : "FAILED",
+				std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+		}
+
+		{
+			//	㲥λAB дÿһݣC  A  Bֻ߶
+			BroadcastRingBuffer<uint64_t> buffer(1024);
+			auto& stage_a = buffer.add_consumer();
+			auto& stage_b = buffer.add_consumer();
+			auto& stage_c = buffer.add_consumer({ &stage_a, &stage_b });
+
+			constexpr uint64_t test_count = 1'000'000;
+			uint64_t sum_a = 0, sum_b = 0, sum_c = 0;
+			std::atomic<bool> ordered{ true };
+
+			auto start_time = std::chrono::high_resolution_clock::now();
+			{
+				std::vector<ThreadGuardJoin> threads;
+				threads.emplace_back(std::thread([&buffer]() {
+					for (uint64_t i = 0; i < test_count;)
+					{
+						if (buffer.write(i)) {
+							++i;
+						}
+					}
+					}));
+
+				auto run = [](auto& consumer, uint64_t& sum, auto&& check) {
+					for (uint64_t n = 0; n < test_count;) {
+						n += consumer.poll([&](const uint64_t& v) { check(v); sum += v; });
+					}
+				};
+
+				threads.emplace_back(std::thread([&]() { run(stage_a, sum_a, [](uint64_t) {}); }));
+				threads.emplace_back(std::thread([&]() { run(stage_b, sum_b, [](uint64_t) {}); }));
+				threads.emplace_back(std::thread([&]() {
+					run(stage_c, sum_c, [&](uint64_t v) {
+						if (stage_a.sequence() <= v || stage_b.sequence() <= v) {
+							ordered.store(false);
+						}
+						});
+					}));
+			}
+			auto end_time = std::chrono::high_resolution_clock::now();
+
+			const uint64_t expect = test_count * (test_count - 1) / 2;
+			const bool ok = ordered.load() && sum_a == expect && sum_b == expect && sum_c == expect;
+			std::print("broadcast ringbuffer 1P3C {} count, {}, use {}ms.\n", test_count, ok ? "passed" : "FAILED",
+				std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+		}
+
+		{
+			//	λ߹ߣУݵ  + ʧ == д
+			struct Trace
+			{
+				uint64_t seq;
+				uint64_t tsc;
+				uint32_t event;
+			};
+
+			LossyRingBuffer<Trace> buffer(1024);
+			LossyRingBuffer<Trace>::Reader reader(buffer);
+			constexpr uint64_t test_count = 1'000'000;
+			std::atomic<bool> done{ false };
+			uint64_t received = 0, overruns = 0;
+			bool ok = true;
+
+			auto start_time = std::chrono::high_resolution_clock::now();
+			{
+				ThreadGuardJoin producer(std::thread([&buffer, &done]() {
+					for (uint64_t i = 0; i < test_count; ++i) {
+						buffer.write(Trace{ i, i * 3, static_cast<uint32_t>(i & 0xff) });
+					}
+					done.store(true);
+					}));
+
+				ThreadGuardJoin consumer(std::thread([&]() {
+					Trace trace;
+					int64_t last = -1;
+					for (;;)
+					{
+						const bool finished = done.load();
+						while (reader.read(trace))
+						{
+							ok = ok && static_cast<int64_t>(trace.seq) > last && trace.tsc == trace.seq * 3;
+							last = static_cast<int64_t>(trace.seq);
+							if (++received % 256 == 0) {
+								std::this_thread::sleep_for(10us);	//	ģ⴦Ķ
+							}
+						}
+
+						if (finished) {
+							break;
+						}
+					}
+					overruns = reader.overruns();
+					}));
+			}
+			auto end_time = std::chrono::high_resolution_clock::now();
+
+			ok = ok && received + overruns == test_count;
+			std::print("lossy ringbuffer {} count, received {}, overruns {}, {}, use {}ms.\n", test_count, received, overruns,
+				ok ? "passed" : "FAILED", std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+		}
+
+		{
+			//	˫ӳ洢Խ洢βд front_bulk Ȼ
+			struct Sample
+			{
+				uint64_t seq;
+				uint32_t channel;
+				float value;
+			};
+
+			SPSCRingBuffer<Sample, MirroredTraits> buffer(100);
+			const uint32_t cap = buffer.capacity();
+			std::vector<Sample> vecIn(cap), vecOut(cap);
+			uint64_t wseq = 0, rseq = 0;
+			bool ok = true;
+			for (int round = 0; round < 64; ++round)
+			{
+				//	ÿд 2/3  2/3 дλòϿԽ洢β
+				const uint32_t n = cap * 2 / 3;
+				for (uint32_t i = 0; i < n; ++i) {
+					vecIn[i] = Sample{ wseq++, i, i * 0.5f };
+				}
+				ok = ok && buffer.write_bulk(vecIn.begin(), n) == n;
+
+				auto view = buffer.front_bulk(n);
+				ok = ok && view.size() == n && view.back().seq == rseq + n - 1;
+				ok = ok && buffer.read_bulk(vecOut.begin(), n) == n;
+				for (uint32_t i = 0; i < n; ++i) {
+					ok = ok && vecOut[i].seq == rseq++;
+				}
+			}
+
+			std::print("mirrored spsc ringbuffer capacity {} test {}.\n", cap, ok ? "passed" : "FAILED");
+		}
+
+		{
+			//	ڴ滷λߺ߷ֱӳͬһڴ棨ַͬʵʹʱλ
+			struct Tick
+			{
+				uint64_t seq;
+				double price;
+			};
+
+			constexpr const char* shm_name = "cppnote_shm_ringbuffer_test";
+			constexpr uint64_t test_count = 1'000'000;
+			ShmSPSCRingBuffer<Tick>::Unlink(shm_name);
+
+			bool ok = true;
+			auto start_time = std::chrono::high_resolution_clock::now();
+			{
+				ShmSPSCRingBuffer<Tick> consumer_side(shm_name, 4096, ShmSPSCRingBuffer<Tick>::Role::Consumer);
+				try {
+					ShmSPSCRingBuffer<Tick> second_consumer(shm_name, 4096, ShmSPSCRingBuffer<Tick>::Role::Consumer);
+					ok = false;		//	ͬһɫֻһ
+				}
+				catch (const std::runtime_error&) {
+				}
+
+				ThreadGuardJoin producer(std::thread([shm_name]() {
+					ShmSPSCRingBuffer<Tick> producer_side(shm_name, 4096, ShmSPSCRingBuffer<Tick>::Role::Producer);
+					for (uint64_t i = 0; i < test_count;)
+					{
+						if (producer_side.write(Tick{ i, i * 0.5 })) {
+							++i;
+						}
+					}
+					}));
+
+				Tick tick;
+				for (uint64_t i = 0; i < test_count;)
+				{
+					if (consumer_side.read(tick)) {
+						ok = ok && tick.seq == i;
+						++i;
+					}
+				}
+				ok = ok && consumer_side.peer_generation() == 1;
+			}
+			auto end_time = std::chrono::high_resolution_clock::now();
+
+			//	Ͽɫ
+			try {
+				ShmSPSCRingBuffer<Tick> consumer_side(shm_name, 4096, ShmSPSCRingBuffer<Tick>::Role::Consumer);
+				ok = ok && consumer_side.empty();
+			}
+			catch (const std::runtime_error&) {
+				ok = false;
+			}
+			ShmSPSCRingBuffer<Tick>::Unlink(shm_name);
+
+			std::print("shm spsc ringbuffer test {} count, {}, use {}ms.\n", test_count, ok ? "passed" : "FAILED",
+				std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+		}
+
+		{
+			//	ģʽ߿ʱ𣬲ٿתѯ
+			SPSCRingBuffer<TestData, BlockingTraits> buffer(1024);
+			constexpr uint32_t test_count = 65536;
+			uint32_t timeouts = 0;
+
+			auto start_time = std::chrono::high_resolution_clock::now();
+			auto end_time = start_time;
+			{
+				ThreadGuardJoin producer(std::thread([&buffer]() {
+					for (int i = 0; i < test_count; ++i)
+					{
+						if (!buffer.wait_write(100ms, i, i, "", nullptr)) {
+							std::println("wait_write timeout.");
+						}
+
+						if (i % 8192 == 0) {
+							std::this_thread::sleep_for(5ms);	//	ģͻĿ
+						}
+					}
+					}));
+
+				ThreadGuardJoin consumer(std::thread([&buffer, &end_time, &timeouts]() {
+					TestData item;
+					for (uint32_t i = 0; i < test_count;)
+					{
+						if (buffer.wait_read(item, 100ms)) {
+							++i;
+						}
+						else {
+							++timeouts;
+						}
+					}
+					end_time = std::chrono::high_resolution_clock::now();
+					}));
+			}
+
+			std::print("blocking spsc ringbuffer test write and read {} count, timeouts {}, use {}ms.\n", test_count, timeouts,
+				std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+		}
+
+		{
+			//	ģʽ MPMCС¶дͬʱȴλУûݱǻʧÿдߵݱ˳
+			//	ticket ʵֵĶߴԤԼֻõ
+			MPMCRingBuffer<uint64_t, BlockingTraits> buffer(16);
+			constexpr uint32_t producers = 4;
+			constexpr uint64_t per_producer = 20'000;
+			std::atomic<uint32_t> timeouts{ 0 };
+			bool ordered = true;
+			uint64_t read_count = 0;
+			uint64_t read_sum = 0;
+
+			auto start_time = std::chrono::high_resolution_clock::now();
+			{
+				std::vector<ThreadGuardJoin> threads;
+				for (uint32_t p = 0; p < producers; ++p)
+				{
+					threads.emplace_back(std::thread([&buffer, &timeouts, p]() {
+						for (uint64_t i = 0; i < per_producer;)
+						{
+							if (buffer.wait_write(100ms, (static_cast<uint64_t>(p) << 32) | i)) {
+								++i;
+							}
+							else {
+								timeouts.fetch_add(1, std::memory_order_relaxed);
+							}
+						}
+						}));
+				}
+
+				threads.emplace_back(std::thread([&]() {
+					std::vector<uint64_t> next(producers, 0);
+					uint64_t v;
+					while (read_count < producers * per_producer)
+					{
+						if (!buffer.wait_read(v, 100ms)) {
+							timeouts.fetch_add(1, std::memory_order_relaxed);
+							continue;
+						}
+
+						const uint32_t p = static_cast<uint32_t>(v >> 32);
+						if (p >= producers || (v & 0xffffffff) != next[p]) {
+							ordered = false;
+						}
+						else {
+							++next[p];
+						}
+						read_sum += v & 0xffffffff;
+						++read_count;
+					}
+					}));
+			}
+			auto end_time = std::chrono::high_resolution_clock::now();
+
+			const bool ok = ordered && read_sum == producers * (per_producer * (per_producer - 1) / 2);
+			std::print("blocking mpmc ringbuffer 4P1C test {} count, {}, timeouts {}, use {}ms.\n", read_count, ok ? "passed" : "FAILED",
+				timeouts.load(), std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+		}
+
+		{
+			//	ƣдλôǰʼ32λ64λӦȷƵ
+			constexpr uint64_t test_count = 100'000;
+			const bool ok32 = WrapAroundTest<DefultTraits>(UINT32_MAX - 100, test_count);
+			const bool ok64 = WrapAroundTest<LargeTraits>(UINT64_MAX - 100, test_count);
+			std::print("spsc ringbuffer wraparound test uint32 index {}, uint64 index {}.\n",
+				ok32 ? "passed" : "FAILED", ok64 ? "passed" : "FAILED");
+
+			SPSCThroughput<LargeTraits>("uint64 index + huge pages", 10'000'000);
+
+			//	 4G Ԫأֻҳ棬ϵͳ޷ṩôĵַռ/ύʱ
+			try
+			{
+				SPSCRingBuffer<char, LargeTraits> huge((uint64_t(1) << 32) + 1);
+				bool ok = huge.capacity() > UINT32_MAX;
+				std::vector<char> data(4096, 'x');
+				ok = ok && huge.write_bulk(data.begin(), data.end()) == data.size();
+				ok = ok && huge.read_bulk(data.begin(), static_cast<uint64_t>(data.size())) == data.size();
+				std::print("spsc ringbuffer capacity {} test {}.\n", huge.capacity(), ok ? "passed" : "FAILED");
+			}
+			catch (const std::bad_alloc&)
+			{
+				std::print("spsc ringbuffer capacity > 4G skipped, not enough address space.\n");
+			}
+		}
+
 		std::print(" ===== RingBuffer End =====\n");
 	}
 };
\ No newline at end of file
@@ -4,19 +4,969 @@
 #include <memory>
 #include <functional>
 #include <coroutine>
+#include <optional>
+#include <variant>
+#include <tuple>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <cstddef>
+#include <bit>
 
 #include "Observer.h"
+#include "stl_thread.h"
+#include "MemoryPool.h"
 
 class STL_Coroutine : public Observer
 {
 public:
 
-	
+	//	void  when_all / when_any  std::monostate ʾ
+	template<typename T>
+	using NonVoid = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+	template<typename T, typename = void>
+	struct PromiseResult
+	{
+		template<typename U>
+		void return_value(U&& v)
+		{
+			value.emplace(std::forward<U>(v));
+		}
+
+		T take()
+		{
+			return std::move(*value);
+		}
+
+		std::optional<T> value;
+	};
+
+	template<typename D>
+	struct PromiseResult<void, D>
+	{
+		void return_void() noexcept {}
+		void take() noexcept {}
+	};
+
+	//	Э֡ʹȫ operator new
+	struct HeapFrame
+	{
+	};
+
+	//	Э֡İ̷ּ߳ڴأ֡СΪ 64B ~ 2KB ÿһ MemoryPool::SimpleMemoryPool operator new
+	//	֡ǰͷ¼ĳ飺߳ͷŵ֡ŽԭӲ̻߳棬߳ͷʱ Recycle ԭ
+	//	SimpleMemoryPool ̷ֻ߳䡢̹߳黹ջ ABA
+	//	߳˳ʱ鲻ͷţ֮󴴽̸߳ã̳߳е֡ʼЧ
+	class FramePool
+	{
+	public:
+
+		static constexpr size_t kClasses = 6;
+		static constexpr size_t kMinClassBytes = 64;
+		static constexpr size_t kAlign = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+		struct Stats
+		{
+			uint64_t allocations = 0;
+			uint64_t deallocations = 0;
+			uint64_t remote_deallocations = 0;	//	߳ͷŵ֡
+			uint64_t fallbacks = 0;				//	󼶱ʹ operator new
+			size_t reserved_bytes = 0;			//	ϵͳڴ
+			size_t pool_sets = 0;				//	ԼͬʱЭ֡߳
+		};
+
+		static void* Allocate(size_t size)
+		{
+			const size_t total = size + sizeof(Header);
+			const uint32_t size_class = static_cast<uint32_t>(std::bit_width((total - 1) / kMinClassBytes));
+
+			PoolSet* set = tls_set;
+			if (set == nullptr) {
+				set = &Local();
+			}
+			Bump(set->allocations);
+
+			void* block;
+			if (size_class < kClasses) {
+				block = set->cache[size_class];
+				if (block != nullptr) {
+					set->cache[size_class] = *static_cast<void**>(block);
+				}
+				else {
+					block = set->Alloc(size_class);
+				}
+			}
+			else {
+				Bump(set->fallbacks);
+				block = ::operator new(total, std::align_val_t{ kAlign });
+			}
+
+			Header* header = static_cast<Header*>(block);
+			header->owner = set;
+			header->size_class = size_class;
+			return header + 1;
+		}
+
+		static void Deallocate(void* p) noexcept
+		{
+			Header* header = static_cast<Header*>(p) - 1;
+			PoolSet* owner = header->owner;
+			const uint32_t size_class = header->size_class;
+			if (owner == tls_set) {
+				Bump(owner->local_deallocations);
+				if (size_class < kClasses) {
+					*reinterpret_cast<void**>(header) = owner->cache[size_class];
+					owner->cache[size_class] = header;
+					return;
+				}
+			}
+			else {
+				owner->remote_deallocations.fetch_add(1, std::memory_order_relaxed);
+				if (size_class < kClasses) {
+					owner->Free(size_class, header);
+					return;
+				}
+			}
+			::operator delete(header, std::align_val_t{ kAlign });
+		}
+
+		//	гۼ
+		static Stats stats()
+		{
+			Registry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			Stats s;
+			for (PoolSet* set : registry.all) {
+				s.allocations += set->allocations.load(std::memory_order_relaxed);
+				const uint64_t remote = set->remote_deallocations.load(std::memory_order_relaxed);
+				s.deallocations += set->local_deallocations.load(std::memory_order_relaxed) + remote;
+				s.remote_deallocations += remote;
+				s.fallbacks += set->fallbacks.load(std::memory_order_relaxed);
+				s.reserved_bytes += set->reserved_bytes.load(std::memory_order_relaxed);
+			}
+			s.pool_sets = registry.all.size();
+			return s;
+		}
+
+	private:
+
+		struct PoolSet;
+
+		struct alignas(kAlign) Header
+		{
+			PoolSet* owner;
+			uint32_t size_class;
+		};
+
+		template<size_t Bytes>
+		struct alignas(kAlign) Block
+		{
+			std::byte data[Bytes];
+		};
+
+		//	С֡ÿ 128 ֡ 32 
+		template<size_t I>
+		using ClassPool = MemoryPool::SimpleMemoryPool<Block<(kMinClassBytes << I)>, (I < 3 ? 128 : 32)>;
+
+		template<typename Seq>
+		struct PoolTuple;
+
+		template<size_t... I>
+		struct PoolTuple<std::index_sequence<I...>>
+		{
+			using type = std::tuple<ClassPool<I>...>;
+		};
+
+		struct PoolSet
+		{
+			PoolSet() : reserved_bytes(Reserved(std::make_index_sequence<kClasses>{}))
+			{
+			}
+
+			//	Capacity ȡ _blocks ֻ߳ʱ޸ģȽǰǵ reserved_bytes  stats ȡ
+			template<size_t I = 0>
+			void* Alloc(uint32_t size_class)
+			{
+				if constexpr (I + 1 < kClasses) {
+					if (size_class != I) {
+						return Alloc<I + 1>(size_class);
+					}
+				}
+
+				auto& pool = std::get<I>(pools);
+				const size_t capacity = pool.Capacity();
+				void* p = pool.Alloc();
+				if (pool.Capacity() != capacity) {
+					reserved_bytes.store(reserved_bytes.load(std::memory_order_relaxed)
+						+ (pool.Capacity() - capacity) * sizeof(Block<(kMinClassBytes << I)>), std::memory_order_relaxed);
+				}
+				return p;
+			}
+
+			template<size_t I = 0>
+			void Free(uint32_t size_class, void* p) noexcept
+			{
+				if constexpr (I + 1 < kClasses) {
+					if (size_class != I) {
+						return Free<I + 1>(size_class, p);
+					}
+				}
+				std::get<I>(pools).Recycle(static_cast<Block<(kMinClassBytes << I)>*>(p));
+			}
+
+			template<size_t... I>
+			size_t Reserved(std::index_sequence<I...>) const
+			{
+				return ((std::get<I>(pools).Capacity() * sizeof(Block<(kMinClassBytes << I)>)) + ... + size_t(0));
+			}
+
+			typename PoolTuple<std::make_index_sequence<kClasses>>::type pools;
+
+			//	̶ֻ߳д
+			void* cache[kClasses] = {};
+			std::atomic<size_t> reserved_bytes;
+			std::atomic<uint64_t> allocations{ 0 };
+			std::atomic<uint64_t> local_deallocations{ 0 };
+			std::atomic<uint64_t> fallbacks{ 0 };
+
+			alignas(64) std::atomic<uint64_t> remote_deallocations{ 0 };
+		};
+
+		//	һдߵļҪԭӵĶд
+		static void Bump(std::atomic<uint64_t>& counter) noexcept
+		{
+			counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+
+		//	˳ʱֲ߳̾ھ̬
+		struct Registry
+		{
+			std::mutex mutex;
+			std::vector<PoolSet*> all;
+			std::vector<PoolSet*> idle;
+		};
+
+		static Registry& GetRegistry()
+		{
+			static Registry* registry = new Registry();
+			return *registry;
+		}
+
+		struct LocalSet
+		{
+			LocalSet()
+			{
+				Registry& registry = GetRegistry();
+				std::lock_guard<std::mutex> lock(registry.mutex);
+				if (!registry.idle.empty()) {
+					set = registry.idle.back();
+					registry.idle.pop_back();
+				}
+				else {
+					set = new PoolSet();
+					registry.all.push_back(set);
+				}
+				tls_set = set;
+			}
+
+			~LocalSet()
+			{
+				tls_set = nullptr;
+				Registry& registry = GetRegistry();
+				std::lock_guard<std::mutex> lock(registry.mutex);
+				registry.idle.push_back(set);
+			}
+
+			PoolSet* set = nullptr;
+		};
+
+		static PoolSet& Local()
+		{
+			thread_local LocalSet local;
+			return *local.set;
+		}
+
+		inline static thread_local PoolSet* tls_set = nullptr;
+	};
+
+	//	Э֡ FramePool 䣺promise ̳к󣬱ΪЭ֡ operator new/delete
+	struct PooledFrame
+	{
+		static void* operator new(size_t size)
+		{
+			return FramePool::Allocate(size);
+		}
+
+		static void operator delete(void* p, size_t) noexcept
+		{
+			FramePool::Deallocate(p);
+		}
+	};
+
+	//	Э񣺴ʱִУ co_await ʱſʼ
+	//	Գתƣco_await ʱֱлЭ̣Э̽ʱֱлصȴߣǶҲջ
+	//	FrameAlloc Э֡ķ䷽ʽHeapFrame  PooledFrame
+	template<typename T, typename FrameAlloc>
+	class BasicTask
+	{
+	public:
+
+		struct promise_type;
+		using handle_type = std::coroutine_handle<promise_type>;
+
+		struct FinalAwaiter
+		{
+			bool await_ready() noexcept { return false; }
+
+			std::coroutine_handle<> await_suspend(handle_type h) noexcept
+			{
+				std::coroutine_handle<> continuation = h.promise().continuation;
+				return continuation ? continuation : std::noop_coroutine();
+			}
+
+			void await_resume() noexcept {}
+		};
+
+		struct promise_type : PromiseResult<T>, FrameAlloc
+		{
+			BasicTask get_return_object() noexcept
+			{
+				return BasicTask(handle_type::from_promise(*this));
+			}
+
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			FinalAwaiter final_suspend() noexcept { return {}; }
+
+			void unhandled_exception() noexcept
+			{
+				error = std::current_exception();
+			}
+
+			T result()
+			{
+				if (error) {
+					std::rethrow_exception(error);
+				}
+				return this->take();
+			}
+
+			std::coroutine_handle<> continuation;
+			std::exception_ptr error;
+		};
+
+		struct Awaiter
+		{
+			bool await_ready() noexcept
+			{
+				return !handle || handle.done();
+			}
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+			{
+				handle.promise().continuation = caller;
+				return handle;
+			}
+
+			T await_resume()
+			{
+				if (!handle) {
+					throw std::logic_error("co_await on an empty task");
+				}
+				return handle.promise().result();
+			}
+
+			handle_type handle;
+		};
+
+		BasicTask() noexcept = default;
+		explicit BasicTask(handle_type h) noexcept : _handle(h) {}
+		BasicTask(BasicTask&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+
+		BasicTask& operator=(BasicTask&& other) noexcept
+		{
+			if (this != &other) {
+				if (_handle) {
+					_handle.destroy();
+				}
+				_handle = std::exchange(other._handle, nullptr);
+			}
+			return *this;
+		}
+
+		~BasicTask()
+		{
+			if (_handle) {
+				_handle.destroy();
+			}
+		}
+
+		BasicTask(const BasicTask&) = delete;
+		BasicTask& operator=(const BasicTask&) = delete;
+
+		Awaiter operator co_await() const noexcept
+		{
+			return Awaiter{ _handle };
+		}
+
+		bool valid() const noexcept { return static_cast<bool>(_handle); }
+		bool done() const noexcept { return _handle && _handle.done(); }
+
+	private:
+
+		handle_type _handle;
+	};
+
+	template<typename T = void>
+	using Task = BasicTask<T, HeapFrame>;
+
+	template<typename T = void>
+	using PooledTask = BasicTask<T, PooledFrame>;
+
+	//	ʼʱٵЭ̣ͨЭ
+	struct Detached
+	{
+		struct promise_type
+		{
+			Detached get_return_object() noexcept { return {}; }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() noexcept { std::terminate(); }
+		};
+	};
+
+	//	co_await schedule(pool)̳߳лָڳصĹִ߳
+	template<typename Pool>
+	struct ScheduleAwaiter
+	{
+		bool await_ready() noexcept { return false; }
+
+		void await_suspend(std::coroutine_handle<> h)
+		{
+			pool.Post([h]() { h.resume(); });
+		}
+
+		void await_resume() noexcept {}
+
+		Pool& pool;
+	};
+
+	template<typename Pool>
+	static ScheduleAwaiter<Pool> schedule(Pool& pool) noexcept
+	{
+		return ScheduleAwaiter<Pool>{ pool };
+	}
+
+	//	co_await sleep_for(...)ʱ֣ںʱ̳߳лָռ߳
+	struct SleepAwaiter
+	{
+		bool await_ready() const noexcept
+		{
+			return when <= STL_Thread::TimerWheel::Clock::now();
+		}
+
+		void await_suspend(std::coroutine_handle<> h)
+		{
+			wheel.schedule_at(when, [h]() { h.resume(); });
+		}
+
+		void await_resume() noexcept {}
+
+		STL_Thread::TimerWheel& wheel;
+		STL_Thread::TimerWheel::Clock::time_point when;
+	};
+
+	static SleepAwaiter sleep_until(STL_Thread::TimerWheel::Clock::time_point when, STL_Thread::TimerWheel& wheel = STL_Thread::TimerWheel::instance())
+	{
+		return SleepAwaiter{ wheel, when };
+	}
+
+	static SleepAwaiter sleep_for(STL_Thread::TimerWheel::Clock::duration delay, STL_Thread::TimerWheel& wheel = STL_Thread::TimerWheel::instance())
+	{
+		return SleepAwaiter{ wheel, STL_Thread::TimerWheel::Clock::now() + delay };
+	}
+
+	//	̳߳񣬲ȴ
+	template<typename Pool, typename A>
+	static Detached spawn(Pool& pool, BasicTask<void, A> task)
+	{
+		co_await schedule(pool);
+		try {
+			co_await task;
+		}
+		catch (const std::exception& e) {
+			std::print("spawn task exception : {}.\n", e.what());
+		}
+	}
+
+	//	ֱ߳ɣؽ׳쳣Ҫ̳߳صĹ߳ϵ
+	template<typename T, typename A>
+	static T sync_wait(BasicTask<T, A> task)
+	{
+		SyncState<T> state;
+		SyncRun(task, state);
+
+		std::unique_lock<std::mutex> lock(state.mutex);
+		state.cond.wait(lock, [&state]() { return state.done; });
+		if (state.error) {
+			std::rethrow_exception(state.error);
+		}
+		if constexpr (!std::is_void_v<T>) {
+			return std::move(*state.value);
+		}
+	}
+
+	//	ȴȫɣ˳򷵻أһ׳쳣ʱȫɺ׳һ
+	//	ڵǰ߳οʼ co_await schedule(pool) ֮Ųִ
+	template<typename A, typename... Ts>
+	static BasicTask<std::tuple<NonVoid<Ts>...>, A> when_all(BasicTask<Ts, A>... tasks)
+	{
+		std::tuple<std::optional<NonVoid<Ts>>...> slots;
+		std::array<std::exception_ptr, sizeof...(Ts)> errors;
+		Countdown countdown(sizeof...(Ts));
+
+		co_await CountdownAwaiter{ countdown, [&]() {
+			[&]<size_t... I>(std::index_sequence<I...>) {
+				(RunInto(std::get<I>(std::tie(tasks...)), std::get<I>(slots), errors[I], countdown), ...);
+			}(std::index_sequence_for<Ts...>{});
+			} };
+
+		for (auto& error : errors) {
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+		co_return std::apply([](auto&... slot) { return std::tuple<NonVoid<Ts>...>(std::move(*slot)...); }, slots);
+	}
+
+	template<typename T, typename A>
+	static BasicTask<std::vector<NonVoid<T>>, A> when_all(std::vector<BasicTask<T, A>> tasks)
+	{
+		std::vector<std::optional<NonVoid<T>>> slots(tasks.size());
+		std::vector<std::exception_ptr> errors(tasks.size());
+		Countdown countdown(tasks.size());
+
+		co_await CountdownAwaiter{ countdown, [&]() {
+			for (size_t i = 0; i < tasks.size(); ++i) {
+				RunInto(tasks[i], slots[i], errors[i], countdown);
+			}
+			} };
+
+		for (auto& error : errors) {
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+		std::vector<NonVoid<T>> results;
+		results.reserve(slots.size());
+		for (auto& slot : slots) {
+			results.push_back(std::move(*slot));
+		}
+		co_return results;
+	}
+
+	//	 when_any ʱȴϲͷ
+	//	Щʹõ̳߳ءʱ֮ʹ
+	class WhenAnyScope
+	{
+	public:
+		WhenAnyScope() = default;
+		WhenAnyScope(const WhenAnyScope&) = delete;
+		WhenAnyScope& operator=(const WhenAnyScope&) = delete;
+		~WhenAnyScope() { wait(); }
+
+		void wait()
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_cond.wait(lock, [this]() { return _pending == 0; });
+		}
+
+	private:
+		friend class STL_Coroutine;
+
+		void Enter()
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			++_pending;
+		}
+
+		//	֪ͨȴõʱ÷Ѳٷʱ
+		void Leave()
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (--_pending == 0) {
+				_cond.notify_all();
+			}
+		}
+
+		std::mutex _mutex;
+		std::condition_variable _cond;
+		size_t _pending = 0;
+	};
+
+	//	һɵ±񲻻ᱻȡں̨Ϻͷ
+	//	Իʵߵ̳߳ءʱֵȣҪЩǰȴʱ WhenAnyScope
+	template<typename T, typename A>
+	static BasicTask<std::pair<size_t, NonVoid<T>>, A> when_any(std::vector<BasicTask<T, A>> tasks)
+	{
+		return WhenAny(nullptr, std::move(tasks));
+	}
+
+	template<typename T, typename A>
+	static BasicTask<std::pair<size_t, NonVoid<T>>, A> when_any(WhenAnyScope& scope, std::vector<BasicTask<T, A>> tasks)
+	{
+		return WhenAny(&scope, std::move(tasks));
+	}
+
+	template<typename T, typename A, typename... Ts>
+	static BasicTask<std::pair<size_t, NonVoid<T>>, A> when_any(BasicTask<T, A> first, BasicTask<Ts, A>... rest)
+	{
+		return WhenAny(nullptr, MakeTasks(std::move(first), std::move(rest)...));
+	}
+
+	template<typename T, typename A, typename... Ts>
+	static BasicTask<std::pair<size_t, NonVoid<T>>, A> when_any(WhenAnyScope& scope, BasicTask<T, A> first, BasicTask<Ts, A>... rest)
+	{
+		return WhenAny(&scope, MakeTasks(std::move(first), std::move(rest)...));
+	}
+
+private:
+
+	template<typename T, typename A, typename... Ts>
+	static std::vector<BasicTask<T, A>> MakeTasks(BasicTask<T, A> first, BasicTask<Ts, A>... rest)
+	{
+		std::vector<BasicTask<T, A>> tasks;
+		tasks.reserve(1 + sizeof...(Ts));
+		tasks.push_back(std::move(first));
+		(tasks.push_back(std::move(rest)), ...);
+		return tasks;
+	}
+
+	template<typename T, typename A>
+	static BasicTask<std::pair<size_t, NonVoid<T>>, A> WhenAny(WhenAnyScope* scope, std::vector<BasicTask<T, A>> tasks)
+	{
+		if (tasks.empty()) {
+			throw std::invalid_argument("when_any requires at least one task");
+		}
+
+		auto state = std::make_shared<AnyState<T, A>>(tasks.size(), scope);
+		state->tasks = std::move(tasks);
+		if (scope) {
+			scope->Enter();
+		}
+		co_await CountdownAwaiter{ state->countdown, [&state]() {
+			for (size_t i = 0; i < state->tasks.size(); ++i) {
+				RunAny(state, i);
+			}
+			} };
+
+		if (state->error) {
+			std::rethrow_exception(state->error);
+		}
+		co_return std::pair<size_t, NonVoid<T>>(state->index, std::move(*state->value));
+	}
+
+	//	 n+1 ʼ 1 ɵȴȫݼ˭ 0 ˭ָȴ
+	//	ͬʱ await_suspend ǰָȴ
+	struct Countdown
+	{
+		explicit Countdown(size_t n) : count(n + 1) {}
+
+		void Arrive()
+		{
+			if (count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				waiter.resume();
+			}
+		}
+
+		std::atomic<size_t> count;
+		std::coroutine_handle<> waiter;
+	};
+
+	template<typename Start>
+	struct CountdownAwaiter
+	{
+		bool await_ready() noexcept { return false; }
+
+		bool await_suspend(std::coroutine_handle<> h)
+		{
+			countdown.waiter = h;
+			start();
+			return countdown.count.fetch_sub(1, std::memory_order_acq_rel) != 1;
+		}
+
+		void await_resume() noexcept {}
+
+		Countdown& countdown;
+		Start start;
+	};
+
+	template<typename T, typename A>
+	static Detached RunInto(BasicTask<T, A>& task, std::optional<NonVoid<T>>& slot, std::exception_ptr& error, Countdown& countdown)
+	{
+		try {
+			if constexpr (std::is_void_v<T>) {
+				co_await task;
+				slot.emplace();
+			}
+			else {
+				slot.emplace(co_await task);
+			}
+		}
+		catch (...) {
+			error = std::current_exception();
+		}
+		countdown.Arrive();
+	}
+
+	template<typename T, typename A>
+	struct AnyState
+	{
+		AnyState(size_t n, WhenAnyScope* s) : countdown(1), pending(n), scope(s) {}
+
+		std::vector<BasicTask<T, A>> tasks;
+		std::atomic_bool won{ false };
+		size_t index = 0;
+		std::optional<NonVoid<T>> value;
+		std::exception_ptr error;
+		Countdown countdown;
+		std::atomic<size_t> pending;	//	δϵ
+		WhenAnyScope* scope;
+	};
+
+	template<typename T, typename A>
+	static Detached RunAny(std::shared_ptr<AnyState<T, A>> state, size_t index)
+	{
+		std::optional<NonVoid<T>> value;
+		std::exception_ptr error;
+		try {
+			if constexpr (std::is_void_v<T>) {
+				co_await state->tasks[index];
+				value.emplace();
+			}
+			else {
+				value.emplace(co_await state->tasks[index]);
+			}
+		}
+		catch (...) {
+			error = std::current_exception();
+		}
+
+		if (!state->won.exchange(true, std::memory_order_acq_rel)) {
+			state->index = index;
+			state->value = std::move(value);
+			state->error = error;
+			state->countdown.Arrive();
+		}
+
+		//	һͷԼе״̬ͬЭ֪֡ͨ scope
+		if (state->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			WhenAnyScope* scope = state->scope;
+			state.reset();
+			if (scope) {
+				scope->Leave();
+			}
+		}
+	}
+
+	template<typename T>
+	struct SyncState
+	{
+		std::mutex mutex;
+		std::condition_variable cond;
+		bool done = false;
+		std::optional<NonVoid<T>> value;
+		std::exception_ptr error;
+	};
+
+	//	ɱò֪ͨsync_wait õʱЭѲٷ state
+	template<typename T, typename A>
+	static Detached SyncRun(BasicTask<T, A>& task, SyncState<T>& state)
+	{
+		try {
+			if constexpr (std::is_void_v<T>) {
+				co_await task;
+			}
+			else {
+				state.value.emplace(co_await task);
+			}
+		}
+		catch (...) {
+			state.error = std::current_exception();
+		}
+
+		std::lock_guard<std::mutex> lock(state.mutex);
+		state.done = true;
+		state.cond.notify_one();
+	}
+
+public:
+
+	//	ģһ첽 I/Oе̳߳أʱϵȴ latency
+	static Task<std::string> FetchAsync(STL_Thread::WorkStealingPool& pool, STL_Thread::TimerWheel& wheel, std::string what, std::chrono::milliseconds latency)
+	{
+		co_await schedule(pool);
+		co_await sleep_for(latency, wheel);
+		co_return what;
+	}
+
+	static Task<std::string> FailAsync(STL_Thread::WorkStealingPool& pool)
+	{
+		co_await schedule(pool);
+		throw std::runtime_error("request failed");
+	}
+
+	//	̣лȡû붩ȡȷصĿ棻ûлصǶףȴڼҲռ߳
+	static Task<std::string> HandleRequest(STL_Thread::WorkStealingPool& pool, STL_Thread::TimerWheel& wheel, WhenAnyScope& replicas, int id)
+	{
+		using namespace std::chrono_literals;
+		auto [user, orders] = co_await when_all(FetchAsync(pool, wheel, "user" + std::to_string(id), 20ms), FetchAsync(pool, wheel, "orders", 30ms));
+		auto [replica, stock] = co_await when_any(replicas, FetchAsync(pool, wheel, "stock", 50ms), FetchAsync(pool, wheel, "stock", 10ms));
+		co_return user + " " + orders + " " + stock + "@" + std::to_string(replica);
+	}
+
+	//	Ƕ n  co_await Գתµջ
+	static Task<uint64_t> DeepChain(uint32_t n)
+	{
+		if (n == 0) {
+			co_return 0;
+		}
+		co_return 1 + co_await DeepChain(n - 1);
+	}
+
+	template<typename TaskType = Task<void>>
+	static TaskType Hop(STL_Thread::WorkStealingPool& pool, std::atomic<uint32_t>& hops)
+	{
+		co_await schedule(pool);
+		hops.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	//	ɵĶЭ̣Э֡ķͷ
+	template<typename TaskType>
+	static TaskType Leaf(uint64_t value)
+	{
+		co_return value;
+	}
+
+	//	̳߳ϴЭ̣Эһָ̻߳ʱ֡ᱻ黹̵߳ĳ
+	static PooledTask<void> FanOut(STL_Thread::WorkStealingPool& pool, std::atomic<uint32_t>& hops)
+	{
+		co_await schedule(pool);
+		co_await when_all(Hop<PooledTask<void>>(pool, hops), Hop<PooledTask<void>>(pool, hops));
+	}
+
+	//	δִв n Э̣ÿЭ֡
+	//	ֱ Awaiter  noop ЭΪ̣δŻĹеջҲ
+	template<typename TaskType>
+	static double FrameAllocBench(const char* name, uint32_t n)
+	{
+		auto start_time = std::chrono::high_resolution_clock::now();
+		uint64_t sum = 0;
+		for (uint32_t i = 0; i < n; ++i) {
+			TaskType task = Leaf<TaskType>(i);
+			auto awaiter = task.operator co_await();
+			awaiter.await_suspend(std::noop_coroutine()).resume();
+			sum += awaiter.await_resume();
+		}
+		auto end_time = std::chrono::high_resolution_clock::now();
+		const auto us = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+		const double rate = us > 0 ? static_cast<double>(n) * 1e6 / us : 0.0;
+		std::print("coroutine frame {} : {} coroutines (sum {}), use {}ms, {:.2f} M frames/s.\n", name, n, sum, us / 1000, rate / 1e6);
+		return rate;
+	}
 
 	void Test() override
 	{
 		std::print(" ===== STL_Coroutine Bgein =====\n");
 
+		using namespace std::chrono_literals;
+		{
+			STL_Thread::WorkStealingPool pool;
+			STL_Thread::TimerWheel wheel(pool);
+			WhenAnyScope replicas;		//	ʱ̳߳ when_any ĸ
+
+			auto start_time = std::chrono::high_resolution_clock::now();
+			const std::string result = sync_wait(HandleRequest(pool, wheel, replicas, 1));
+			auto end_time = std::chrono::high_resolution_clock::now();
+			std::print("coroutine request : {}, use {}ms (expect ~40ms).\n", result,
+				std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+
+			//	1 ͬһ̣߳ʱԽӽ
+			constexpr int request_count = 10'000;
+			std::vector<Task<std::string>> requests;
+			requests.reserve(request_count);
+			for (int i = 0; i < request_count; ++i) {
+				requests.push_back(HandleRequest(pool, wheel, replicas, i));
+			}
+			start_time = std::chrono::high_resolution_clock::now();
+			const auto results = sync_wait(when_all(std::move(requests)));
+			end_time = std::chrono::high_resolution_clock::now();
+			std::print("coroutine {} concurrent requests on {} threads : {} results, last {}, use {}ms.\n", request_count, pool.size(),
+				results.size(), results.back(), std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+
+			//	ȿÿЭл̳߳һ
+			constexpr uint32_t hop_count = 100'000;
+			std::atomic<uint32_t> hops{ 0 };
+			std::vector<Task<void>> hoppers;
+			hoppers.reserve(hop_count);
+			for (uint32_t i = 0; i < hop_count; ++i) {
+				hoppers.push_back(Hop(pool, hops));
+			}
+			start_time = std::chrono::high_resolution_clock::now();
+			sync_wait(when_all(std::move(hoppers)));
+			end_time = std::chrono::high_resolution_clock::now();
+			const auto us = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+			std::print("coroutine schedule {} hops, use {}ms, {:.2f} Mhops/s.\n", hops.load(), us / 1000, us > 0 ? static_cast<double>(hop_count) / us : 0.0);
+
+#ifdef NDEBUG
+			constexpr uint32_t chain_depth = 1'000'000;
+#else
+			constexpr uint32_t chain_depth = 1'000;		//	δŻĹб֤ѶԳתƱβ
+#endif
+			std::print("coroutine deep chain {} (symmetric transfer).\n", sync_wait(DeepChain(chain_depth)));
+
+			try {
+				sync_wait(when_all(FetchAsync(pool, wheel, "ok", 1ms), FailAsync(pool)));
+			}
+			catch (const std::exception& e) {
+				std::print("coroutine exception : {}.\n", e.what());
+			}
+
+			//	ػЭ֡ڸ֮߳ͷ
+			hops = 0;
+			const FramePool::Stats before = FramePool::stats();
+			std::vector<PooledTask<void>> fanouts;
+			fanouts.reserve(hop_count / 2);
+			for (uint32_t i = 0; i < hop_count / 2; ++i) {
+				fanouts.push_back(FanOut(pool, hops));
+			}
+			start_time = std::chrono::high_resolution_clock::now();
+			sync_wait(when_all(std::move(fanouts)));
+			end_time = std::chrono::high_resolution_clock::now();
+			const FramePool::Stats after = FramePool::stats();
+			std::print("coroutine pooled fan-out {} hops, use {}ms, frames {}, remote frees {}.\n", hops.load(),
+				std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count(),
+				after.allocations - before.allocations, after.remote_deallocations - before.remote_deallocations);
+		}
+
+		{
+			constexpr uint32_t frame_count = 10'000'000;
+			const FramePool::Stats before = FramePool::stats();
+			const double heap_rate = FrameAllocBench<Task<uint64_t>>("operator new", frame_count);
+			const double pooled_rate = FrameAllocBench<PooledTask<uint64_t>>("FramePool", frame_count);
+			const FramePool::Stats after = FramePool::stats();
+			std::print("coroutine frame pool : {:.2f}x, allocations {}, deallocations {}, remote {}, fallbacks {}, reserved {}KB in {} pool sets.\n",
+				heap_rate > 0 ? pooled_rate / heap_rate : 0.0,
+				after.allocations - before.allocations, after.deallocations - before.deallocations,
+				after.remote_deallocations - before.remote_deallocations, after.fallbacks - before.fallbacks,
+				after.reserved_bytes / 1024, after.pool_sets);
+		}
 
 		std::print(" ===== STL_Coroutine End =====\n");
 	}
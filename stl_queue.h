@@ -2,6 +2,14 @@
 
 #include <print>
 #include <queue>
+#include <vector>
+#include <algorithm>
+#include <bit>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 #include "Observer.h"
 #include "ringbuffer.h"
 #include "concurrentqueue.h"
@@ -13,9 +21,14 @@ class STL_Queue : public Observer
 {
 public:
 
+	//	Уpop أpop_wait/drain_wait ȴ
+	//	drain/pop_all һμȡԪأѭclose ܾ֮д룬ȴȫ
 	template<class T, class LockType = std::mutex>
 	class LockQueue
 	{
+		using CondType = std::conditional_t<std::is_same_v<LockType, std::mutex>,
+			std::condition_variable, std::condition_variable_any>;
+
 	public:
 
 		LockQueue() = default;
@@ -24,23 +37,33 @@ public:
 		LockQueue(LockQueue const&) = delete;
 		LockQueue& operator=(LockQueue const&) = delete;
 
-		void push(const T& value)
+		//	ѹرʱfalse
+		bool push(const T& value)
 		{
-			std::lock_guard<LockType> lock(_lock);
+			std::unique_lock<LockType> lock(_lock);
+			if (_closed) return false;
 			_q.push(value);
+			notify(lock);
+			return true;
 		}
 
-		void push(T&& value)
+		bool push(T&& value)
 		{
-			std::lock_guard<LockType> lock(_lock);
+			std::unique_lock<LockType> lock(_lock);
+			if (_closed) return false;
 			_q.push(std::move(value));
+			notify(lock);
+			return true;
 		}
 
 		template<typename... Args>
-		void emplace(Args&&... args)
+		bool emplace(Args&&... args)
 		{
-			std::lock_guard<LockType> lock(_lock);
+			std::unique_lock<LockType> lock(_lock);
+			if (_closed) return false;
 			_q.emplace(std::forward<Args>(args)...);
+			notify(lock);
+			return true;
 		}
 
 		bool pop(T& o)
@@ -52,6 +75,59 @@ public:
 			return true;
 		}
 
+		//	ȴֱݣʱѹرΪʱfalse
+		template<class Rep, class Period>
+		bool pop_wait(T& o, const std::chrono::duration<Rep, Period>& timeout)
+		{
+			std::unique_lock<LockType> lock(_lock);
+			if (!wait(lock, timeout)) return false;
+			o = std::move(_q.front());
+			_q.pop();
+			return true;
+		}
+
+		//	һμȡȫԪ
+		std::queue<T> pop_all()
+		{
+			std::queue<T> out;
+			std::lock_guard<LockType> lock(_lock);
+			out.swap(_q);
+			return out;
+		}
+
+		//	һμȡ max Ԫд outȡ
+		template<typename OutputIt>
+		std::size_t drain(OutputIt out, std::size_t max)
+		{
+			std::lock_guard<LockType> lock(_lock);
+			return drain_locked(out, max);
+		}
+
+		//	ȴֱݺһȡ max ʱѹرΪʱ0
+		template<typename OutputIt, class Rep, class Period>
+		std::size_t drain_wait(OutputIt out, std::size_t max, const std::chrono::duration<Rep, Period>& timeout)
+		{
+			std::unique_lock<LockType> lock(_lock);
+			if (!wait(lock, timeout)) return 0;
+			return drain_locked(out, max);
+		}
+
+		//	رպ push ʧܣԿȡе߱
+		void close()
+		{
+			{
+				std::lock_guard<LockType> lock(_lock);
+				_closed = true;
+			}
+			_cond.notify_all();
+		}
+
+		bool closed() const
+		{
+			std::lock_guard<LockType> lock(_lock);
+			return _closed;
+		}
+
 		std::size_t size() const noexcept
 		{
 			std::lock_guard<LockType> lock(_lock);
@@ -66,18 +142,65 @@ public:
 
 	private:
 
+		//	ֻдڵȴʱ֪ͨ÷Ҫϵͳ
+		void notify(std::unique_lock<LockType>& lock)
+		{
+			if (_waiters == 0) return;
+			lock.unlock();
+			_cond.notify_one();
+		}
+
+		template<class Rep, class Period>
+		bool wait(std::unique_lock<LockType>& lock, const std::chrono::duration<Rep, Period>& timeout)
+		{
+			++_waiters;
+			const bool ready = _cond.wait_for(lock, timeout, [this] { return !_q.empty() || _closed; });
+			--_waiters;
+			return ready && !_q.empty();
+		}
+
+		template<typename OutputIt>
+		std::size_t drain_locked(OutputIt out, std::size_t max)
+		{
+			std::size_t n = 0;
+			for (; n < max && !_q.empty(); ++n)
+			{
+				*out++ = std::move(_q.front());
+				_q.pop();
+			}
+			return n;
+		}
+
 		std::queue<T> _q;
 		mutable LockType _lock;
+		CondType _cond;
+		uint32_t _waiters = 0;
+		bool _closed = false;
 	};
 
+	//	ڵڲڵأߴӿջȡڵ㣬߳Ӻ黹غľʱ˻ new/delete
+	//	ջǶͬʱ Treiber ջջΪ (, 汾) 64λֵÿ޸İ汾ż1ABA
+	//	pool_size Ϊ0ʱÿϢ new/deleteܶԱ
 	template<typename T>
 	class MPSCQueueNonIntrusive
 	{
 	public:
-		MPSCQueueNonIntrusive() : _head(new Node()), _tail(_head.load(std::memory_order_relaxed))
+		explicit MPSCQueueNonIntrusive(uint32_t pool_size = 4096)
+			: _pool(pool_size ? new Node[pool_size] : nullptr)
+			, _free(Pack(kNil, 0))
 		{
-			Node* front = _head.load(std::memory_order_relaxed);
-			front->Next.store(nullptr, std::memory_order_relaxed);
+			for (uint32_t i = 0; i < pool_size; ++i)
+			{
+				_pool[i].Index = i;
+				_pool[i].FreeNext.store(i + 1 < pool_size ? i + 1 : kNil, std::memory_order_relaxed);
+			}
+			if (pool_size) {
+				_free.store(Pack(0, 0), std::memory_order_relaxed);
+			}
+
+			Node* front = AllocNode(nullptr);
+			_head.store(front, std::memory_order_relaxed);
+			_tail.store(front, std::memory_order_relaxed);
 		}
 
 		~MPSCQueueNonIntrusive()
@@ -87,12 +210,12 @@ public:
 				delete output;
 
 			Node* front = _head.load(std::memory_order_relaxed);
-			delete front;
+			FreeNode(front);
 		}
 
 		void Enqueue(T* input)
 		{
-			Node* node = new Node(input);
+			Node* node = AllocNode(input);
 			Node* prevHead = _head.exchange(node, std::memory_order_acq_rel);
 			prevHead->Next.store(node, std::memory_order_release);
 		}
@@ -106,11 +229,13 @@ public:
 
 			result = next->Data;
 			_tail.store(next, std::memory_order_release);
-			delete tail;
+			FreeNode(tail);
 			return true;
 		}
 
 	private:
+		static constexpr uint32_t kNil = UINT32_MAX;
+
 		struct Node
 		{
 			Node() = default;
@@ -120,12 +245,57 @@ public:
 				Next.store(nullptr, std::memory_order_relaxed);
 			}
 
-			T* Data;
-			std::atomic<Node*> Next;
+			T* Data = nullptr;
+			std::atomic<Node*> Next{ nullptr };
+			std::atomic<uint32_t> FreeNext{ kNil };	//	ջӣܱоջ߲ȡ
+			uint32_t Index = kNil;						//	kNil ʾ new Ľڵ
 		};
 
-		std::atomic<Node*> _head;
-		std::atomic<Node*> _tail;
+		static uint64_t Pack(uint32_t index, uint32_t tag) noexcept
+		{
+			return (static_cast<uint64_t>(tag) << 32) | index;
+		}
+
+		static uint32_t IndexOf(uint64_t v) noexcept { return static_cast<uint32_t>(v); }
+		static uint32_t TagOf(uint64_t v) noexcept { return static_cast<uint32_t>(v >> 32); }
+
+		Node* AllocNode(T* data)
+		{
+			uint64_t top = _free.load(std::memory_order_acquire);
+			while (IndexOf(top) != kNil)
+			{
+				Node* node = &_pool[IndexOf(top)];
+				const uint64_t next = Pack(node->FreeNext.load(std::memory_order_relaxed), TagOf(top) + 1);
+				if (_free.compare_exchange_weak(top, next, std::memory_order_acquire, std::memory_order_acquire))
+				{
+					node->Data = data;
+					node->Next.store(nullptr, std::memory_order_relaxed);
+					return node;
+				}
+			}
+			return new Node(data);
+		}
+
+		//	ֻߵ
+		void FreeNode(Node* node)
+		{
+			if (node->Index == kNil)
+			{
+				delete node;
+				return;
+			}
+
+			uint64_t top = _free.load(std::memory_order_relaxed);
+			do {
+				node->FreeNext.store(IndexOf(top), std::memory_order_relaxed);
+			} while (!_free.compare_exchange_weak(top, Pack(node->Index, TagOf(top) + 1),
+				std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		std::unique_ptr<Node[]> _pool;
+		alignas(64) std::atomic<uint64_t> _free;
+		alignas(64) std::atomic<Node*> _head;
+		alignas(64) std::atomic<Node*> _tail;
 
 		MPSCQueueNonIntrusive(MPSCQueueNonIntrusive const&) = delete;
 		MPSCQueueNonIntrusive& operator=(MPSCQueueNonIntrusive const&) = delete;
@@ -211,6 +381,282 @@ public:
 		MPSCQueueIntrusive& operator=(MPSCQueueIntrusive const&) = delete;
 	};
 
+	//	༶ȼУ̶ Levels ȼ0ߣÿһMPMCУͬһͬȽȳ
+	//	ǿλͼ¼ݵļ𣬳ʱ countr_zero ֱӶλȼ̽
+	//	ϸȼӣȼʱȼἢ
+	template<class T, uint32_t Levels = 8>
+	class MultiLevelQueue
+	{
+		static_assert(Levels > 0 && Levels <= 64, "MultiLevelQueue supports 1 to 64 levels");
+
+	public:
+
+		static constexpr uint32_t kLevels = Levels;
+		static constexpr uint32_t kNormal = Levels / 2;	//	δָȼʱʹã¶
+
+		MultiLevelQueue() = default;
+		~MultiLevelQueue() = default;
+
+		MultiLevelQueue(MultiLevelQueue const&) = delete;
+		MultiLevelQueue& operator=(MultiLevelQueue const&) = delete;
+
+		bool push(const T& value, uint32_t priority = kNormal)
+		{
+			assert(priority < Levels);
+			if (!_bands[priority].enqueue(value)) {
+				return false;
+			}
+			_bitmap.fetch_or(uint64_t(1) << priority, std::memory_order_acq_rel);
+			return true;
+		}
+
+		bool push(T&& value, uint32_t priority = kNormal)
+		{
+			assert(priority < Levels);
+			if (!_bands[priority].enqueue(std::move(value))) {
+				return false;
+			}
+			_bitmap.fetch_or(uint64_t(1) << priority, std::memory_order_acq_rel);
+			return true;
+		}
+
+		//	ȡȼߵԪأpriority ѡڼ
+		bool pop(T& o, uint32_t* priority = nullptr)
+		{
+			uint64_t bitmap = _bitmap.load(std::memory_order_acquire);
+			while (bitmap != 0)
+			{
+				const uint32_t level = static_cast<uint32_t>(std::countr_zero(bitmap));
+				if (try_pop_level(level, o)) {
+					if (priority) *priority = level;
+					return true;
+				}
+				bitmap &= bitmap - 1;
+			}
+			return false;
+		}
+
+		//	ֵ޸ʱο
+		std::size_t size() const noexcept
+		{
+			std::size_t n = 0;
+			for (auto& band : _bands) {
+				n += band.size_approx();
+			}
+			return n;
+		}
+
+		std::size_t size(uint32_t priority) const noexcept
+		{
+			return _bands[priority].size_approx();
+		}
+
+		bool empty() const noexcept
+		{
+			return _bitmap.load(std::memory_order_acquire) == 0;
+		}
+
+	private:
+
+		//	ΪʱλͼһΣ֮ǰλacq_rel ֤ܿԪأ
+		//	֮λλͼȻΪ1˲ݵλͼΪ0
+		bool try_pop_level(uint32_t level, T& o)
+		{
+			auto& band = _bands[level];
+			if (band.try_dequeue(o)) {
+				return true;
+			}
+
+			const uint64_t bit = uint64_t(1) << level;
+			_bitmap.fetch_and(~bit, std::memory_order_acq_rel);
+			if (band.try_dequeue(o)) {
+				_bitmap.fetch_or(bit, std::memory_order_acq_rel);	//	ܻʣָ࣬λͼ
+				return true;
+			}
+			return false;
+		}
+
+		std::array<moodycamel::ConcurrentQueue<T>, Levels> _bands;
+		alignas(64) std::atomic<uint64_t> _bitmap{ 0 };
+	};
+
+	//	ндһУ̶ʱ try_enqueue ʧܡenqueue_wait ȴڴ治ֵ
+	//	ݴ MPMCSlotRingBuffer У_count ¼ռдǰռλȷΪ capacity
+	//	ߵˮλڷѹﵽ high ʱ on_highͣȡsocket䵽 low ʱ on_low ָ
+	//	صڴ/߳СлصʱִУصﲻдȡ
+	template<class T>
+	class BoundedMPSCQueue
+	{
+	public:
+
+		using Callback = std::function<void()>;
+
+		explicit BoundedMPSCQueue(uint32_t capacity)
+			: _ring(capacity)
+			, _capacity(capacity)
+		{
+			assert(capacity > 0);
+		}
+
+		BoundedMPSCQueue(BoundedMPSCQueue const&) = delete;
+		BoundedMPSCQueue& operator=(BoundedMPSCQueue const&) = delete;
+
+		//	Ҫڿʼд֮ǰãlow С high
+		void set_watermarks(uint32_t high, uint32_t low, Callback on_high, Callback on_low)
+		{
+			assert(low < high && high <= _capacity);
+			_high = high;
+			_low = low;
+			_onHigh = std::move(on_high);
+			_onLow = std::move(on_low);
+		}
+
+		template<typename... Args>
+		bool try_enqueue(Args&&... args)
+		{
+			if (!reserve()) {
+				return false; // full
+			}
+
+			//	ռλɹ˵пвλtry_write ֻΪδдزλŶʧ
+			while (!_ring.try_write(std::forward<Args>(args)...)) {
+				asm_volatile_pause();
+			}
+			_notEmpty.notify();
+			return true;
+		}
+
+		//	ʱȴڳռ䣬ʱfalse
+		template<class Rep, class Period, typename... Args>
+		bool enqueue_wait(const std::chrono::duration<Rep, Period>& timeout, Args&&... args)
+		{
+			return wait_for(_notFull, timeout, [&]() { return try_enqueue(std::forward<Args>(args)...); });
+		}
+
+		//	ֻΨһߵ
+		bool try_dequeue(T& item)
+		{
+			if (!_ring.try_read(item)) {
+				return false;
+			}
+
+			const uint32_t n = _count.fetch_sub(1, std::memory_order_seq_cst) - 1;
+			_notFull.notify();
+			if (_onLow && n <= _low && _above.load(std::memory_order_seq_cst)) {
+				check_watermark();
+			}
+			return true;
+		}
+
+		template<class Rep, class Period>
+		bool dequeue_wait(T& item, const std::chrono::duration<Rep, Period>& timeout)
+		{
+			return wait_for(_notEmpty, timeout, [&]() { return try_dequeue(item); });
+		}
+
+		uint32_t size() const noexcept
+		{
+			return _count.load(std::memory_order_acquire);
+		}
+
+		uint32_t capacity() const noexcept
+		{
+			return _capacity;
+		}
+
+		bool empty() const noexcept
+		{
+			return size() == 0;
+		}
+
+		//	ǰǷڸˮλѵ on_high δ on_low
+		bool above_high_watermark() const noexcept
+		{
+			return _above.load(std::memory_order_acquire);
+		}
+
+	private:
+
+		static constexpr uint32_t kSpinCutoff = RingBuffer::DefultTraits::kSpinCutoff;
+
+		bool reserve()
+		{
+			uint32_t n = _count.load(std::memory_order_relaxed);
+			do {
+				if (n >= _capacity) {
+					return false;
+				}
+			} while (!_count.compare_exchange_weak(n, n + 1, std::memory_order_seq_cst, std::memory_order_relaxed));
+
+			if (_onHigh && n + 1 >= _high && !_above.load(std::memory_order_seq_cst)) {
+				check_watermark();
+			}
+			return true;
+		}
+
+		//	ڻصڸлˮλ״ֱ̬״̬ȶ
+		//	_count  _above  seq_cstλ󸴲߼󸴲״̬һܿԷ© on_low
+		void check_watermark()
+		{
+			std::lock_guard<std::mutex> lock(_watermarkLock);
+			for (;;)
+			{
+				const uint32_t n = _count.load(std::memory_order_seq_cst);
+				if (!_above.load(std::memory_order_relaxed) && n >= _high) {
+					_above.store(true, std::memory_order_seq_cst);
+					_onHigh();
+				}
+				else if (_above.load(std::memory_order_relaxed) && n <= _low) {
+					_above.store(false, std::memory_order_seq_cst);
+					_onLow();
+				}
+				else {
+					break;
+				}
+			}
+		}
+
+		//	ٵǼǵ ec Ϲ𣻵ǼǺһΣⶪʧ֪ͨ
+		template<class Rep, class Period, typename TryOp>
+		static bool wait_for(RingBuffer::EventCount& ec, const std::chrono::duration<Rep, Period>& timeout, TryOp&& try_op)
+		{
+			for (uint32_t spin = 0; spin < kSpinCutoff; ++spin) {
+				if (try_op()) {
+					return true;
+				}
+				asm_volatile_pause();
+			}
+
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			for (;;)
+			{
+				const uint32_t key = ec.prepare_wait();
+				if (try_op()) {
+					ec.cancel_wait();
+					return true;
+				}
+
+				if (!ec.wait(key, deadline)) {
+					return try_op();
+				}
+			}
+		}
+
+		RingBuffer::MPMCSlotRingBuffer<T> _ring;
+		const uint32_t _capacity;
+		alignas(64) std::atomic<uint32_t> _count{ 0 };
+		std::atomic<bool> _above{ false };
+
+		RingBuffer::EventCount _notEmpty;
+		RingBuffer::EventCount _notFull;
+
+		uint32_t _high = 0;
+		uint32_t _low = 0;
+		Callback _onHigh;
+		Callback _onLow;
+		std::mutex _watermarkLock;
+	};
+
 
 	//	ǿ׵õ
 	template<class T>
@@ -237,6 +683,14 @@ public:
 	template<class T>
 	using ConcurrentQueue = moodycamel::ConcurrentQueue<T>;
 
+	//	 ༶ȼ дȼȳͬһͬFIFO
+	template<class T>
+	using PriorityQueue = MultiLevelQueue<T>;
+
+	//	 н дһʱѹ
+	template<class T>
+	using BoundedQueue = BoundedMPSCQueue<T>;
+
 
 	struct node
 	{
@@ -244,13 +698,190 @@ public:
 		char str[32];
 
 		node() = default;
+		//	ֻ s ʵʳȣ 31 ֽڣಹ 0ַʱԽȡ
 		node(int v, const char* s)
 			: data(v)
 		{
-			std::memcpy(str, s, sizeof(str) - 1);
+			const std::size_t n = strnlen(s, sizeof(str) - 1);
+			std::memcpy(str, s, n);
+			std::memset(str + n, 0, sizeof(str) - n);
 		}
 	};
 
+	//	׼Ϣʱ + 䵽 Size ֽ
+	template<std::size_t Size>
+	struct bench_msg
+	{
+		static_assert(Size > sizeof(int64_t), "bench_msg size must be larger than the timestamp");
+
+		int64_t stamp;
+		char payload[Size - sizeof(int64_t)];
+	};
+
+	//	ģʽSteady д룬Burst ÿд kBurst תһʱ䣬ģͻ
+	enum class BenchPattern { Steady, Burst };
+
+	static int64_t BenchNow() noexcept
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	//	ͳһѹ⣺ÿϢЯʱ߼¼ӵӵӳ٣º p50/p99/p999
+	//	push(msg&) дԤȷϢֱַָpop(msg&) ȡһʱfalse
+	template<class Msg, typename Push, typename Pop>
+	static void QueueBench(const char* name, uint32_t producers, uint32_t consumers, uint32_t per_producer,
+		BenchPattern pattern, Push&& push, Pop&& pop)
+	{
+		constexpr uint32_t kBurst = 64;
+		constexpr int64_t kBurstGapNs = 20'000;
+		const uint64_t total = static_cast<uint64_t>(producers) * per_producer;
+		std::vector<std::vector<Msg>> messages(producers, std::vector<Msg>(per_producer));
+		std::vector<std::vector<int64_t>> latencies(consumers);
+		std::atomic<uint64_t> read_count{ 0 };
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+		{
+			std::vector<ThreadGuardJoin> threads;
+			threads.reserve(producers + consumers);
+			for (uint32_t c = 0; c < consumers; ++c)
+			{
+				threads.emplace_back(std::thread([&pop, &read_count, &latency = latencies[c], total]() {
+					latency.reserve(total);
+					Msg msg;
+					while (read_count.load(std::memory_order_relaxed) < total)
+					{
+						if (pop(msg)) {
+							latency.push_back(BenchNow() - msg.stamp);
+							read_count.fetch_add(1, std::memory_order_relaxed);
+						}
+					}
+					}));
+			}
+
+			for (uint32_t p = 0; p < producers; ++p)
+			{
+				threads.emplace_back(std::thread([&push, &msgs = messages[p], pattern]() {
+					for (std::size_t i = 0; i < msgs.size(); ++i)
+					{
+						msgs[i].stamp = BenchNow();
+						push(msgs[i]);
+						if (pattern == BenchPattern::Burst && i % kBurst == kBurst - 1) {
+							//	ת sleepWindows ˯߾Ǻ뼶
+							for (const int64_t until = BenchNow() + kBurstGapNs; BenchNow() < until;) {
+								asm_volatile_pause();
+							}
+						}
+					}
+					}));
+			}
+		}
+		auto end_time = std::chrono::high_resolution_clock::now();
+
+		std::vector<int64_t> all;
+		all.reserve(total);
+		for (auto& latency : latencies) {
+			all.insert(all.end(), latency.begin(), latency.end());
+		}
+
+		auto percentile = [&all](double q) -> int64_t {
+			if (all.empty()) return 0;
+			auto it = all.begin() + std::min(all.size() - 1, static_cast<std::size_t>(q * all.size()));
+			std::nth_element(all.begin(), it, all.end());
+			return *it;
+			};
+
+		const auto us = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+		std::print("{:<16} {}P{}C {:>4}B {:<6} {:>7.2f} Mops/s, latency p50 {}ns, p99 {}ns, p999 {}ns.\n",
+			name, producers, consumers, sizeof(Msg), pattern == BenchPattern::Steady ? "steady" : "burst",
+			us > 0 ? static_cast<double>(total) / us : 0.0, percentile(0.5), percentile(0.99), percentile(0.999));
+	}
+
+	//	жбͬ /ģʽ ¶ԱȣϢС Size ָ
+	//	SPSCQueue ֻ 1P1CMPSCQueue/BoundedQueue ǵ߶УMPMCRingBuffer ߴԤԼҲֻⵥ
+	template<std::size_t Size>
+	static void QueueBenchSuite(uint32_t per_producer)
+	{
+		using Msg = bench_msg<Size>;
+		struct Topology
+		{
+			uint32_t producers;
+			uint32_t consumers;
+		};
+
+		for (auto pattern : { BenchPattern::Steady, BenchPattern::Burst })
+		{
+			for (auto [producers, consumers] : { Topology{ 1, 1 }, Topology{ 4, 1 }, Topology{ 4, 4 } })
+			{
+				{
+					MutexQueue<Msg> q;
+					QueueBench<Msg>("MutexQueue", producers, consumers, per_producer, pattern,
+						[&](Msg& m) { q.push(m); },
+						[&](Msg& m) { return q.pop(m); });
+				}
+
+				{
+					SpinQueue<Msg> q;
+					QueueBench<Msg>("SpinQueue", producers, consumers, per_producer, pattern,
+						[&](Msg& m) { q.push(m); },
+						[&](Msg& m) { return q.pop(m); });
+				}
+
+				{
+					ConcurrentQueue<Msg> q;
+					QueueBench<Msg>("ConcurrentQueue", producers, consumers, per_producer, pattern,
+						[&](Msg& m) { q.enqueue(m); },
+						[&](Msg& m) { return q.try_dequeue(m); });
+				}
+
+				{
+					PriorityQueue<Msg> q;
+					QueueBench<Msg>("PriorityQueue", producers, consumers, per_producer, pattern,
+						[&](Msg& m) { q.push(m); },
+						[&](Msg& m) { return q.pop(m); });
+				}
+
+				if (consumers == 1)
+				{
+					MPSCQueue<Msg> q;
+					QueueBench<Msg>("MPSCQueue", producers, consumers, per_producer, pattern,
+						[&](Msg& m) { q.Enqueue(&m); },
+						[&](Msg& m) {
+							Msg* p = nullptr;
+							if (!q.Dequeue(p)) return false;
+							m = *p;
+							return true;
+						});
+				}
+
+				if (consumers == 1)
+				{
+					BoundedQueue<Msg> q(4096);
+					QueueBench<Msg>("BoundedQueue", producers, consumers, per_producer, pattern,
+						[&](Msg& m) { while (!q.try_enqueue(m)) asm_volatile_pause(); },
+						[&](Msg& m) { return q.try_dequeue(m); });
+				}
+
+				if (consumers == 1)
+				{
+					//	write ˻ḲδݣõԪص write_bulkֵȶڳռ䣬нһбѹ
+					RingBuffer::MPMCRingBuffer<Msg> q(65536);
+					QueueBench<Msg>("MPMCRingBuffer", producers, consumers, per_producer, pattern,
+						[&](Msg& m) { q.write_bulk(&m, 1u); },
+						[&](Msg& m) { return q.read(m); });
+				}
+
+				if (producers == 1 && consumers == 1)
+				{
+					SPSCQueue<Msg> q(4096);
+					QueueBench<Msg>("SPSCQueue", producers, consumers, per_producer, pattern,
+						[&](Msg& m) { while (!q.write(m)) asm_volatile_pause(); },
+						[&](Msg& m) { return q.read(m); });
+				}
+			}
+		}
+	}
+
 	void Test() override
 	{
 		std::print(" ===== STL_Queue Bgein =====\n");
@@ -454,6 +1085,241 @@ public:
 				std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());*/
 		}
 
+		{
+			//	ȼУ֤߳˳
+			PriorityQueue<int> prio_que;
+			prio_que.push(50);
+			prio_que.push(70, 7);
+			prio_que.push(0, 0);
+			prio_que.push(51);
+			prio_que.push(1, 0);
+
+			std::vector<int> order;
+			int value = 0;
+			while (prio_que.pop(value)) {
+				order.push_back(value);
+			}
+			const bool ok = order == std::vector<int>{ 0, 1, 50, 51, 70 } && prio_que.empty();
+			std::print("PriorityQueue order test {}.\n", ok ? "passed" : "FAILED");
+		}
+
+		{
+			//	ȼУߴ㡢ͨѹʱŶʱ
+			struct task
+			{
+				std::chrono::high_resolution_clock::time_point enqueue_time;
+				uint32_t priority;
+			};
+
+			PriorityQueue<task> prio_que;
+			constexpr uint32_t urgent_every = 64;
+			std::array<std::atomic_uint_fast64_t, 2> wait_us{};
+			std::array<std::atomic_uint_fast64_t, 2> done{};
+			read_count = 0;
+			producers.clear();
+			consumers.clear();
+
+			auto start_time = std::chrono::high_resolution_clock::now();
+			auto end_time = start_time;
+			for (size_t i = 0; i < test_thread_count; i++)
+			{
+				producers.emplace_back(std::thread([&prio_que]() {
+					for (uint32_t n = 0; n < test_count; ++n) {
+						const uint32_t priority = n % urgent_every == 0 ? 0 : decltype(prio_que)::kNormal;
+						prio_que.push({ std::chrono::high_resolution_clock::now(), priority }, priority);
+					}
+					}));
+			}
+
+			for (size_t i = 0; i < test_thread_count; i++)
+			{
+				consumers.emplace_back(std::thread([&prio_que, &end_time, &test_total, &read_count, &wait_us, &done]() {
+					task el;
+					for (;;) {
+						if (prio_que.pop(el)) {
+							const auto wait = std::chrono::high_resolution_clock::now() - el.enqueue_time;
+							const size_t band = el.priority == 0 ? 0 : 1;
+							wait_us[band] += std::chrono::duration_cast<std::chrono::microseconds>(wait).count();
+							++done[band];
+							++read_count;
+						}
+						else {
+							if (test_total == read_count) {
+								end_time = std::chrono::high_resolution_clock::now();
+								break;
+							}
+						}
+					}
+					}));
+			}
+
+			std::this_thread::sleep_for(1s);
+			producers.clear();
+			consumers.clear();
+			std::print("PriorityQueue test {} count, thread num {}, use {}ms, avg wait urgent {}us, normal {}us.\n", test_total, test_thread_count,
+				std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count(),
+				done[0] ? wait_us[0] / done[0] : 0, done[1] ? wait_us[1] / done[1] : 0);
+		}
+
+		{
+			//	MPSC ڵأÿϢ new/delete ڵ  ڵ ĶԱȣϢԤȷ䣬ֻͳƶеĿ
+			std::vector<node> payload(test_count);
+			for (uint32_t producer_count : { 1u, 2u, 4u })
+			{
+				for (uint32_t pool_size : { 0u, 4096u })
+				{
+					MPSCQueue<node> mpsc_que(pool_size);
+					const uint64_t total = static_cast<uint64_t>(producer_count) * test_count;
+					uint64_t received = 0;
+
+					auto start_time = std::chrono::high_resolution_clock::now();
+					{
+						producers.clear();
+						for (uint32_t i = 0; i < producer_count; i++)
+						{
+							producers.emplace_back(std::thread([&mpsc_que, &payload]() {
+								for (auto& el : payload) {
+									mpsc_que.Enqueue(&el);
+								}
+								}));
+						}
+
+						node* el = nullptr;
+						while (received < total)
+						{
+							if (mpsc_que.Dequeue(el)) {
+								++received;
+							}
+						}
+						producers.clear();
+					}
+					auto end_time = std::chrono::high_resolution_clock::now();
+
+					const auto us = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+					std::print("MPSCQueue {} test {} count, producer num {}, use {}ms, {:.2f} Mops/s.\n",
+						pool_size ? "node pool" : "new/delete", total, producer_count, us / 1000,
+						us ? static_cast<double>(total) / us : 0.0);
+				}
+			}
+		}
+
+		{
+			//	У pop ѯ  drain_wait ȡĶԱȣclose ֪ͨ˳
+			for (std::size_t batch : { std::size_t(1), std::size_t(256) })
+			{
+				MutexQueue<node> block_que;
+				uint64_t received = 0;
+				producers.clear();
+
+				auto start_time = std::chrono::high_resolution_clock::now();
+				{
+					ThreadGuardJoin consumer(std::thread([&block_que, &received, batch]() {
+						std::vector<node> out;
+						out.reserve(batch);
+						node el;
+						for (;;) {
+							if (batch == 1) {
+								if (block_que.pop(el)) {
+									++received;
+								}
+								else if (block_que.closed() && block_que.empty()) {
+									break;
+								}
+							}
+							else {
+								out.clear();
+								const auto n = block_que.drain_wait(std::back_inserter(out), batch, 100ms);
+								if (n == 0 && block_que.closed()) {
+									break;
+								}
+								received += n;
+							}
+						}
+						}));
+
+					for (size_t i = 0; i < test_thread_count; i++)
+					{
+						producers.emplace_back(std::thread([&block_que]() {
+							for (int n = 0; n < test_count; ++n) {
+								block_que.push({ n, "" });
+							}
+							}));
+					}
+					producers.clear();
+					block_que.close();
+				}
+				auto end_time = std::chrono::high_resolution_clock::now();
+
+				std::print("MutexQueue {} test {} count, producer num {}, received {}, use {}ms.\n",
+					batch == 1 ? "pop" : "drain_wait", test_total, test_thread_count, received,
+					std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+			}
+
+			MutexQueue<int> closed_que;
+			closed_que.push(1);
+			closed_que.close();
+			int value = 0;
+			const bool ok = !closed_que.push(2) && closed_que.pop_wait(value, 10ms) && value == 1
+				&& !closed_que.pop_wait(value, 10ms);
+			std::print("MutexQueue close test {}.\n", ok ? "passed" : "FAILED");
+		}
+
+		{
+			//	нзѹͣ٣ʱ enqueue_wait 𣬸ߵˮλصģͣ/ָȡsocket
+			BoundedQueue<node> bounded_que(1024);
+			std::atomic<uint32_t> pause_count{ 0 };
+			std::atomic<uint32_t> resume_count{ 0 };
+			std::atomic<uint32_t> timeouts{ 0 };
+			bounded_que.set_watermarks(768, 256,
+				[&pause_count]() { ++pause_count; },
+				[&resume_count]() { ++resume_count; });
+
+			uint64_t received = 0;
+			uint64_t corrupted = 0;
+			uint32_t max_size = 0;
+			producers.clear();
+
+			auto start_time = std::chrono::high_resolution_clock::now();
+			{
+				for (size_t i = 0; i < test_thread_count; i++)
+				{
+					producers.emplace_back(std::thread([&bounded_que, &timeouts]() {
+						for (int n = 0; n < test_count;) {
+							if (bounded_que.enqueue_wait(100ms, n, "bounded")) {
+								++n;
+							}
+							else {
+								++timeouts;
+							}
+						}
+						}));
+				}
+
+				node el;
+				while (received < test_total)
+				{
+					max_size = std::max(max_size, bounded_que.size());
+					if (bounded_que.dequeue_wait(el, 100ms)) {
+						corrupted += std::strcmp(el.str, "bounded") != 0 ? 1 : 0;
+						if (++received % 16384 == 0) {
+							std::this_thread::sleep_for(1ms);	//	ģߴ
+						}
+					}
+				}
+				producers.clear();
+			}
+			auto end_time = std::chrono::high_resolution_clock::now();
+
+			std::print("BoundedQueue test {} count, producer num {}, received {}, corrupted {}, max size {}/{}, pause {}, resume {}, timeouts {}, use {}ms.\n",
+				test_total, test_thread_count, received, corrupted, max_size, bounded_que.capacity(), pause_count.load(), resume_count.load(),
+				timeouts.load(), std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+		}
+
+		{
+			//	ͳһ׼ˮ߸׶ε /ϢСģʽ ѡ
+			QueueBenchSuite<16>(100'000);
+			QueueBenchSuite<256>(100'000);
+		}
 
 		std::print(" ===== STL_Queue End =====\n");
 	}
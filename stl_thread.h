@@ -9,8 +9,26 @@
 #include <condition_variable>
 #include <memory>
 #include <type_traits>
+#include <functional>
+#include <vector>
+#include <atomic>
+#include <bit>
+#include <optional>
+#include <variant>
+#include <exception>
+#include <stdexcept>
+#include <latch>
+#include <string>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <array>
 
 #include "Observer.h"
+#include "concurrentqueue.h"
+#include "CpuInfo.h"
+#include "SpinLock.h"
 
 
 thread_local int thread_specific = 0;	// ÿ̶߳
@@ -132,115 +150,2290 @@ public:
 		ThreadManager& operator=(ThreadManager&&) = delete;
 	};
 
-	class ThreadPool	//	̳߳ؼ򵥹ʵ֣Ȳԡؾƣ
+	//	ֻƶ񣺲 kInlineSize Ŀɵöֱӹڲڴ棬˻ضѷ
+	//	std::function Ҫɸƣ packaged_task ֻٰһ shared_ptrڲֻʮֽ
+	class MoveOnlyTask
 	{
 	public:
 
-		using Task = std::function<void()>;
+		static constexpr std::size_t kInlineSize = 48;
+
+		MoveOnlyTask() noexcept = default;
+
+		template<typename F>
+			requires (!std::is_same_v<std::decay_t<F>, MoveOnlyTask>)
+		MoveOnlyTask(F&& f)
+		{
+			using Fn = std::decay_t<F>;
+			if constexpr (kFitsInline<Fn>) {
+				new (_storage) Fn(std::forward<F>(f));
+				_ops = &kInlineOps<Fn>;
+			}
+			else {
+				*reinterpret_cast<Fn**>(_storage) = new Fn(std::forward<F>(f));
+				_ops = &kHeapOps<Fn>;
+			}
+		}
+
+		MoveOnlyTask(MoveOnlyTask&& other) noexcept
+		{
+			take(other);
+		}
+
+		MoveOnlyTask& operator=(MoveOnlyTask&& other) noexcept
+		{
+			if (this != &other) {
+				reset();
+				take(other);
+			}
+			return *this;
+		}
+
+		~MoveOnlyTask()
+		{
+			reset();
+		}
+
+		MoveOnlyTask(const MoveOnlyTask&) = delete;
+		MoveOnlyTask& operator=(const MoveOnlyTask&) = delete;
+
+		void operator()()
+		{
+			_ops->invoke(_storage);
+		}
+
+		explicit operator bool() const noexcept
+		{
+			return _ops != nullptr;
+		}
+
+		void reset() noexcept
+		{
+			if (_ops) {
+				_ops->destroy(_storage);
+				_ops = nullptr;
+			}
+		}
+
+		//	ɵöǷţѷ
+		template<typename Fn>
+		static constexpr bool kFitsInline = sizeof(Fn) <= kInlineSize
+			&& alignof(Fn) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Fn>;
+
+	private:
+
+		struct Ops
+		{
+			void (*invoke)(void* p);
+			void (*move)(void* from, void* to) noexcept;	//	ƶ to  from
+			void (*destroy)(void* p) noexcept;
+		};
+
+		template<typename Fn>
+		static void InlineInvoke(void* p) { (*static_cast<Fn*>(p))(); }
+		template<typename Fn>
+		static void InlineMove(void* from, void* to) noexcept
+		{
+			new (to) Fn(std::move(*static_cast<Fn*>(from)));
+			static_cast<Fn*>(from)->~Fn();
+		}
+		template<typename Fn>
+		static void InlineDestroy(void* p) noexcept { static_cast<Fn*>(p)->~Fn(); }
+
+		template<typename Fn>
+		static void HeapInvoke(void* p) { (**static_cast<Fn**>(p))(); }
+		template<typename Fn>
+		static void HeapMove(void* from, void* to) noexcept { *static_cast<Fn**>(to) = *static_cast<Fn**>(from); }
+		template<typename Fn>
+		static void HeapDestroy(void* p) noexcept { delete *static_cast<Fn**>(p); }
+
+		template<typename Fn>
+		static constexpr Ops kInlineOps{ &InlineInvoke<Fn>, &InlineMove<Fn>, &InlineDestroy<Fn> };
+		template<typename Fn>
+		static constexpr Ops kHeapOps{ &HeapInvoke<Fn>, &HeapMove<Fn>, &HeapDestroy<Fn> };
+
+		void take(MoveOnlyTask& other) noexcept
+		{
+			if (other._ops) {
+				other._ops->move(other._storage, _storage);
+				_ops = other._ops;
+				other._ops = nullptr;
+			}
+		}
+
+		alignas(std::max_align_t) std::byte _storage[kInlineSize];
+		const Ops* _ops = nullptr;
+	};
+
+	//	󻺴棺ÿ̻߳ж󣬳ʱ黹ȫУΪʱٴȫֶȡ
+	//	ⲿ߳롢߳ͷֿ߳תҲܸãȶ״̬ Acquire/Release ڴ
+	template<typename T>
+	class ObjectCache
+	{
+	public:
+
+		static T* Acquire()
+		{
+			LocalCache* local = Local();
+			if (local == nullptr) {
+				T* p;
+				return Global().try_dequeue(p) ? p : new T();
+			}
+
+			if (local->items.empty())
+			{
+				T* batch[kBatch];
+				const std::size_t n = Global().try_dequeue_bulk(batch, kBatch);
+				if (n == 0) {
+					return new T();
+				}
+				local->items.insert(local->items.end(), batch, batch + n);
+			}
+
+			T* p = local->items.back();
+			local->items.pop_back();
+			return p;
+		}
+
+		static void Release(T* p)
+		{
+			LocalCache* local = Local();
+			if (local == nullptr) {
+				Global().enqueue(p);
+				return;
+			}
+
+			local->items.push_back(p);
+			if (local->items.size() >= 2 * kBatch)
+			{
+				Global().enqueue_bulk(local->items.end() - kBatch, kBatch);
+				local->items.resize(local->items.size() - kBatch);
+			}
+		}
+
+	private:
+
+		static constexpr std::size_t kBatch = 32;
+
+		struct LocalCache
+		{
+			LocalCache() { items.reserve(2 * kBatch); }
+			~LocalCache()
+			{
+				tls_destroyed = true;
+				for (T* p : items) delete p;
+			}
+			std::vector<T*> items;
+		};
+
+		//	̵߳Ļʱ nullptr̵ֲ߳߳̾ھ̬
+		//	̳߳ Stop ִ߳ʣʱֱֻʹȫֶ
+		static LocalCache* Local()
+		{
+			if (tls_destroyed) {
+				return nullptr;
+			}
+			thread_local LocalCache cache;
+			return &cache;
+		}
+
+		inline static thread_local bool tls_destroyed = false;		//	û߳̽ǰһֱԶȡ
+
+		//	˳ʱ̬ʱǵĹִ̺߳ Stop ߳Կܷ
+		static moodycamel::ConcurrentQueue<T*>& Global()
+		{
+			static auto* queue = new moodycamel::ConcurrentQueue<T*>();
+			return *queue;
+		}
+	};
+
+	//	ػ promise/future ״̬ ObjectCache˶ͷź黹
+	template<typename R>
+	struct TaskState
+	{
+		using Value = std::conditional_t<std::is_void_v<R>, std::monostate, R>;
+
+		static TaskState* Create()
+		{
+			TaskState* state = ObjectCache<TaskState>::Acquire();
+			state->refs.store(2, std::memory_order_relaxed);	//	һһ TaskFuture
+			return state;
+		}
+
+		static void Release(TaskState* state)
+		{
+			if (state && state->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				state->value.reset();
+				state->error = nullptr;
+				state->ready.store(false, std::memory_order_relaxed);
+				ObjectCache<TaskState>::Release(state);
+			}
+		}
+
+		std::atomic<uint32_t> refs{ 0 };
+		std::atomic<bool> ready{ false };
+		std::optional<Value> value;
+		std::exception_ptr error;
+	};
+
+	//	 futureֻ֧һ getȴʽΪ yield ѯڳڵȴ WorkStealingPool::Waitȴڼִ
+	template<typename R>
+	class TaskFuture
+	{
+	public:
+
+		TaskFuture() noexcept = default;
+		explicit TaskFuture(TaskState<R>* state) noexcept : _state(state) {}
+		TaskFuture(TaskFuture&& other) noexcept : _state(std::exchange(other._state, nullptr)) {}
+
+		TaskFuture& operator=(TaskFuture&& other) noexcept
+		{
+			if (this != &other) {
+				TaskState<R>::Release(_state);
+				_state = std::exchange(other._state, nullptr);
+			}
+			return *this;
+		}
+
+		~TaskFuture()
+		{
+			TaskState<R>::Release(_state);
+		}
+
+		TaskFuture(const TaskFuture&) = delete;
+		TaskFuture& operator=(const TaskFuture&) = delete;
+
+		bool valid() const noexcept { return _state != nullptr; }
+		bool is_ready() const noexcept { return _state->ready.load(std::memory_order_acquire); }
+
+		void wait() const
+		{
+			while (!is_ready()) {
+				std::this_thread::yield();
+			}
+		}
+
+		R get()
+		{
+			wait();
+			TaskState<R>* state = std::exchange(_state, nullptr);
+			if (state->error)
+			{
+				std::exception_ptr error = state->error;
+				TaskState<R>::Release(state);
+				std::rethrow_exception(error);
+			}
+
+			if constexpr (std::is_void_v<R>) {
+				TaskState<R>::Release(state);
+			}
+			else {
+				R value = std::move(*state->value);
+				TaskState<R>::Release(state);
+				return value;
+			}
+		}
+
+	private:
+
+		TaskState<R>* _state = nullptr;
+	};
+
+	//	̰߳󶨲ԣ CpuTopology ̽⵽ˣThreadPool  WorkStealingPool 
+	enum class Placement
+	{
+		None,		//	󶨣ɲϵͳ
+		Compact,	//	ռģ߳ڣڵ㣬̼߳乲
+		Scatter,	//	ÿһ̲߳ڽڵ佻棬ọ́߳ڴ˽л
+	};
+
+	static constexpr uint32_t kUnpinned = UINT32_MAX;
+
+	class ThreadPool	//	̳߳أʱ˯ߣŶӳӹ̣߳гʱ
+	{
+	public:
+
+		using Task = MoveOnlyTask;
+		using Clock = std::chrono::steady_clock;
+
+		struct Options
+		{
+			uint32_t min_workers = std::max(1u, std::thread::hardware_concurrency() / 2);
+			uint32_t max_workers = std::max(1u, std::thread::hardware_concurrency());
+			std::chrono::microseconds spin{ 50 };					//	пպȴʱ0 Ϊ˯
+			std::chrono::microseconds grow_delay{ 1000 };			//	Ŷӳʱûп߳ʱӹ߳
+			std::chrono::milliseconds idle_timeout{ 5000 };		//	˯߳ʱ߳ڶ min_workers ʱ˳
+			Placement placement = Placement::None;				//	 max_workers λɰб
+			std::vector<uint32_t> processors;					//	ǿʱб󶨣CpuTopology::Processor::id placement
+		};
+
+		//	Ŷӳͳƣp50/p99 Ϊ 2 ݷͰϽ
+		struct Stats
+		{
+			uint64_t executed = 0;
+			uint64_t delay_mean_us = 0;
+			uint64_t delay_p50_us = 0;
+			uint64_t delay_p99_us = 0;
+			uint64_t delay_max_us = 0;
+			uint32_t workers = 0;
+			uint32_t peak_workers = 0;
+			uint32_t idle_workers = 0;
+			uint64_t grown = 0;
+			uint64_t retired = 0;
+			uint64_t parks = 0;			//	˯ߵĴÿζҪһλ
+		};
+
+		ThreadPool() : ThreadPool(Options()) {}
+
+		explicit ThreadPool(const Options& options)
+			: _options(options)
+		{
+			_options.min_workers = std::max(1u, _options.min_workers);
+			_options.max_workers = std::max(_options.min_workers, _options.max_workers);
+			if (std::thread::hardware_concurrency() <= 1) {
+				_options.spin = std::chrono::microseconds(0);		//	ֻռסύ߳
+			}
+
+			//	߳ÿλͬʱָֻһ̣߳߳˳λ֮½߳
+			if (!_options.processors.empty()) {
+				_processors = _options.processors;
+			}
+			else if (_options.placement == Placement::Compact) {
+				_processors = CpuTopology::Get().Compact(_options.max_workers);
+			}
+			else if (_options.placement == Placement::Scatter) {
+				_processors = CpuTopology::Get().Scatter(_options.max_workers);
+			}
+			_slotUsed.assign(_processors.size(), false);
+
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (uint32_t i = 0; i < _options.min_workers; ++i) {
+				SpawnWorker();
+			}
+		}
+
+		~ThreadPool()
+		{
+			if (!_stop.load())
+				Stop();
+		}
 
 		inline static ThreadPool& instance() noexcept
 		{
-			static ThreadPool sThreadPool;
-			return sThreadPool;
+			static ThreadPool sThreadPool;
+			return sThreadPool;
+		}
+
+		void Stop()
+		{
+			std::vector<std::thread> threads;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_stop.store(true);
+				for (auto& [id, t] : _threads) {
+					threads.push_back(std::move(t));
+				}
+				_threads.clear();
+				for (auto& t : _retired) {
+					threads.push_back(std::move(t));
+				}
+				_retired.clear();
+			}
+			_condition.notify_all();
+			for (auto& t : threads) {
+				t.join();
+			}
+
+			if (!_tasks.empty())
+				std::print("ThreadPool Stop _tasks size : {}.\n", _tasks.size());
+		}
+
+		//	ύ
+		template<typename F, typename... Args>
+		auto Submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>
+		{
+			using ResultT = std::invoke_result_t<F, Args...>;
+			std::packaged_task<ResultT()> task(
+				[func = std::forward<F>(f), ... captured_args = std::forward<Args>(args)]() mutable {
+					return std::invoke(func, captured_args...);
+				});
+
+			std::future<ResultT> result = task.get_future();
+			Enqueue(Task(std::move(task)));
+			return result;
+		}
+
+		//	ύҪû future ״̬Сհ
+		template<typename F, typename... Args>
+		void Post(F&& f, Args&&... args)
+		{
+			Enqueue(Task([func = std::forward<F>(f), ... captured_args = std::forward<Args>(args)]() mutable {
+				std::invoke(func, captured_args...);
+				}));
+		}
+
+		Stats stats() const
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			Stats s = _stats;
+			s.workers = _workers;
+			s.idle_workers = _sleepers.load() + _spinning.load();
+			s.delay_mean_us = s.executed ? _delaySumUs / s.executed : 0;
+
+			//	Ͱ b Ϊ [2^(b-1), 2^b) ΢
+			auto percentile = [this, &s](uint64_t permille) -> uint64_t {
+				const uint64_t rank = (s.executed * permille + 999) / 1000;
+				uint64_t seen = 0;
+				for (size_t b = 0; b < _delayBuckets.size(); ++b) {
+					seen += _delayBuckets[b];
+					if (seen >= rank && rank > 0) {
+						return b ? (1ull << b) - 1 : 0;
+					}
+				}
+				return s.delay_max_us;
+			};
+			s.delay_p50_us = percentile(500);
+			s.delay_p99_us = percentile(990);
+			return s;
+		}
+
+		void reset_stats()
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stats = Stats();
+			_stats.peak_workers = _workers;
+			_delaySumUs = 0;
+			_delayBuckets.fill(0);
+		}
+
+		uint32_t size() const
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			return _workers;
+		}
+
+		//	߳̿԰󶨵߼δʱΪ
+		const std::vector<uint32_t>& processors() const noexcept
+		{
+			return _processors;
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool(ThreadPool&&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		ThreadPool& operator=(ThreadPool&&) = delete;
+
+	private:
+
+		struct Entry
+		{
+			Task fn;
+			Clock::time_point enqueued;
+		};
+
+		void Enqueue(Task&& task)
+		{
+			const auto now = Clock::now();
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_tasks.push(Entry{ std::move(task), now });
+				_pending.fetch_add(1, std::memory_order_release);
+
+				//	̶߳æҶѵȴãӹ߳
+				if (_sleepers.load() == 0 && _spinning.load() == 0 && now - _tasks.front().enqueued > _options.grow_delay) {
+					TryGrow();
+				}
+			}
+
+			//	ڡ˯ߵǼҲڣȡ˯ᶪʧѣе߳㹻ʱ
+			if (_sleepers.load() > 0 && _pending.load() > _spinning.load()) {
+				_condition.notify_one();
+			}
+		}
+
+		//	ʱ _mutex
+		void TryGrow()
+		{
+			if (_workers < _options.max_workers && !_stop.load()) {
+				SpawnWorker();
+				++_stats.grown;
+			}
+		}
+
+		//	ʱ _mutex߳ȵȴ _threads ֮ſʼ
+		void SpawnWorker()
+		{
+			const uint64_t id = _nextWorkerId++;
+			const auto free_slot = std::find(_slotUsed.begin(), _slotUsed.end(), false);
+			uint32_t slot = kUnpinned;
+			if (free_slot != _slotUsed.end()) {
+				*free_slot = true;
+				slot = static_cast<uint32_t>(free_slot - _slotUsed.begin());
+			}
+			_threads.emplace(id, std::thread([this, id, slot]() { WorkerLoop(id, slot); }));
+			++_workers;
+			_stats.peak_workers = std::max(_stats.peak_workers, _workers);
+		}
+
+		//	ʱ _mutex
+		void RecordDelay(Clock::duration delay)
+		{
+			const uint64_t us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(delay).count());
+			++_stats.executed;
+			_delaySumUs += us;
+			_stats.delay_max_us = std::max(_stats.delay_max_us, us);
+			++_delayBuckets[std::min<size_t>(std::bit_width(us), _delayBuckets.size() - 1)];
+		}
+
+		//	ʱ spin ʱڼӾͲؾ˯ߺͻ
+		void Spin(std::unique_lock<std::mutex>& lock)
+		{
+			_spinning.fetch_add(1);
+			lock.unlock();
+			const auto deadline = Clock::now() + _options.spin;
+			for (uint32_t i = 1; _pending.load(std::memory_order_acquire) == 0 && !_stop.load(std::memory_order_relaxed); ++i)
+			{
+				asm_volatile_pause();
+				if ((i & 63) == 0 && Clock::now() >= deadline) {
+					break;
+				}
+			}
+			_spinning.fetch_sub(1);
+			lock.lock();
+		}
+
+		void WorkerLoop(uint64_t id, uint32_t slot)
+		{
+			if (slot != kUnpinned) {
+				CpuTopology::Get().PinCurrentThread(_processors[slot]);
+			}
+
+			std::vector<std::thread> finished;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				while (true)
+				{
+					if (!_tasks.empty())
+					{
+						Entry entry = std::move(_tasks.front());
+						_tasks.pop();
+						_pending.fetch_sub(1, std::memory_order_relaxed);
+
+						const auto delay = Clock::now() - entry.enqueued;
+						RecordDelay(delay);
+						if (delay > _options.grow_delay && !_tasks.empty() && _sleepers.load() == 0 && _spinning.load() == 0) {
+							TryGrow();
+						}
+						lock.unlock();
+
+						try {
+							entry.fn();
+						}
+						catch (const std::exception& e) {
+							std::print("ThreadPool task exception : {}.\n", e.what());
+						}
+						entry.fn.reset();		//	
+						lock.lock();
+						continue;
+					}
+
+					if (_stop.load())
+						break;
+
+					if (_options.spin.count() > 0)
+					{
+						Spin(lock);
+						if (!_tasks.empty() || _stop.load())
+							continue;
+					}
+
+					_sleepers.fetch_add(1);
+					++_stats.parks;
+					const bool woken = _condition.wait_for(lock, _options.idle_timeout, [this]() {
+						return _stop.load() || !_tasks.empty();
+						});
+					_sleepers.fetch_sub(1);
+
+					if (!woken && _workers > _options.min_workers)
+					{
+						//	˳ǰԼ̶߳󽻸 _retiredһ˳̻߳ Stop  join
+						finished.swap(_retired);
+						auto it = _threads.find(id);
+						_retired.push_back(std::move(it->second));
+						_threads.erase(it);
+						if (slot != kUnpinned) {
+							_slotUsed[slot] = false;
+						}
+						--_workers;
+						++_stats.retired;
+						break;
+					}
+				}
+			}
+
+			for (auto& t : finished) {
+				t.join();
+			}
+		}
+
+		Options _options;
+		std::vector<uint32_t> _processors;
+
+		std::atomic_bool _stop{ false };
+		std::atomic<uint32_t> _sleepers{ 0 };
+		std::atomic<uint32_t> _spinning{ 0 };
+		alignas(64) std::atomic<size_t> _pending{ 0 };		//	ֻ߳
+
+		mutable std::mutex _mutex;
+		std::condition_variable _condition;
+		std::queue<Entry> _tasks;
+
+		//	 _mutex 
+		std::map<uint64_t, std::thread> _threads;
+		std::vector<std::thread> _retired;
+		std::vector<bool> _slotUsed;			//	_processors ѷ̵ָ߳λ
+		uint64_t _nextWorkerId = 0;
+		uint32_t _workers = 0;
+		Stats _stats;
+		uint64_t _delaySumUs = 0;
+		std::array<uint64_t, 32> _delayBuckets{};
+	};
+
+	//	Chase-Lev ȡ˫˶Уο L et al. "Correct and Efficient Work-Stealing for Weak Memory Models"
+	//	ڵײ push/popLIFOղݻڻУȡڶ stealFIFO͵硢ͨ
+	//	ֻݣԱȡ߶ȡʱͷ
+	template<typename T>
+	class WorkStealingDeque
+	{
+		static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void*),
+			"WorkStealingDeque stores small trivially copyable items such as pointers");
+
+	public:
+
+		explicit WorkStealingDeque(int64_t capacity = 1024)
+			: _array(new Array(std::bit_ceil(static_cast<uint64_t>(std::max<int64_t>(capacity, 2)))))
+		{
+		}
+
+		~WorkStealingDeque()
+		{
+			for (Array* a : _garbage) {
+				delete a;
+			}
+			delete _array.load(std::memory_order_relaxed);
+		}
+
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+		//	ֻߵ
+		void push(T item)
+		{
+			const int64_t b = _bottom.load(std::memory_order_relaxed);
+			const int64_t t = _top.load(std::memory_order_acquire);
+			Array* a = _array.load(std::memory_order_relaxed);
+			if (b - t > a->capacity - 1) {
+				_garbage.push_back(a);
+				a = a->grow(b, t);
+				_array.store(a, std::memory_order_release);
+			}
+
+			a->put(b, item);
+			_bottom.store(b + 1, std::memory_order_release);	//	Ԫأ steal ȡ _bottom  acquire 
+		}
+
+		//	ֻߵãӵײȡµԪ
+		bool pop(T& item)
+		{
+			const int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+			Array* a = _array.load(std::memory_order_relaxed);
+			_bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = _top.load(std::memory_order_relaxed);
+
+			if (t > b) {
+				_bottom.store(b + 1, std::memory_order_relaxed);
+				return false; // empty
+			}
+
+			item = a->get(b);
+			if (t == b) {
+				//	ֻʣһȡ߾
+				const bool won = _top.compare_exchange_strong(t, t + 1,
+					std::memory_order_seq_cst, std::memory_order_relaxed);
+				_bottom.store(b + 1, std::memory_order_relaxed);
+				return won;
+			}
+			return true;
+		}
+
+		//	̵߳ãӶȡԪأΪջʧܷfalse
+		bool steal(T& item)
+		{
+			int64_t t = _top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const int64_t b = _bottom.load(std::memory_order_acquire);
+			if (t >= b) {
+				return false; // empty
+			}
+
+			Array* a = _array.load(std::memory_order_acquire);
+			T value = a->get(t);
+			if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				return false; // ߻ȡ
+			}
+			item = value;
+			return true;
+		}
+
+		//	ֵ޸ʱο
+		std::size_t size() const noexcept
+		{
+			const int64_t b = _bottom.load(std::memory_order_relaxed);
+			const int64_t t = _top.load(std::memory_order_relaxed);
+			return b > t ? static_cast<std::size_t>(b - t) : 0;
+		}
+
+		bool empty() const noexcept
+		{
+			return size() == 0;
+		}
+
+	private:
+
+		struct Array
+		{
+			explicit Array(uint64_t cap)
+				: capacity(static_cast<int64_t>(cap))
+				, mask(static_cast<int64_t>(cap) - 1)
+				, slots(new std::atomic<T>[cap])
+			{
+			}
+
+			~Array() { delete[] slots; }
+
+			T get(int64_t i) const noexcept { return slots[i & mask].load(std::memory_order_relaxed); }
+			void put(int64_t i, T v) noexcept { slots[i & mask].store(v, std::memory_order_relaxed); }
+
+			Array* grow(int64_t b, int64_t t) const
+			{
+				Array* a = new Array(static_cast<uint64_t>(capacity) * 2);
+				for (int64_t i = t; i < b; ++i) {
+					a->put(i, get(i));
+				}
+				return a;
+			}
+
+			const int64_t capacity;
+			const int64_t mask;
+			std::atomic<T>* const slots;
+		};
+
+		alignas(64) std::atomic<int64_t> _top{ 0 };
+		alignas(64) std::atomic<int64_t> _bottom{ 0 };
+		alignas(64) std::atomic<Array*> _array;
+		std::vector<Array*> _garbage;	//	˽
+	};
+
+	//	ȡ̳߳أÿ߳һ Chase-Lev ˫˶Уⲿ߳ύȫע
+	//	߳ύԼеĵײʱγ ԼĶСעСλÿʼȡ߳
+	//	Submit ӿ ThreadPool ͬfork/join ʱ Wait ȴ񣬵ȴڼִ߳
+	class WorkStealingPool
+	{
+	public:
+
+		using Task = MoveOnlyTask;
+
+		using Placement = STL_Thread::Placement;
+		static constexpr uint32_t kUnpinned = STL_Thread::kUnpinned;
+
+		//	threads Ϊ0ʱʹȫ߼
+		explicit WorkStealingPool(uint32_t threads = 0, Placement placement = Placement::None)
+		{
+			const uint32_t count = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+			switch (placement)
+			{
+			case Placement::Compact:
+				Start(CpuTopology::Get().Compact(count));
+				break;
+			case Placement::Scatter:
+				Start(CpuTopology::Get().Scatter(count));
+				break;
+			default:
+				Start(std::vector<uint32_t>(count, kUnpinned));
+				break;
+			}
+		}
+
+		//	ÿ̰߳󶨵һָ߼CpuTopology::Processor::idkUnpinned ʾ
+		explicit WorkStealingPool(std::vector<uint32_t> processors)
+		{
+			if (processors.empty()) {
+				processors.assign(std::max(1u, std::thread::hardware_concurrency()), kUnpinned);
+			}
+			Start(std::move(processors));
+		}
+
+		~WorkStealingPool()
+		{
+			if (!_stop.load())
+				Stop();
+		}
+
+		inline static WorkStealingPool& instance() noexcept
+		{
+			static WorkStealingPool sPool;
+			return sPool;
+		}
+
+		//	ֹ̣ͣ߳δִеڵִ֤߳꣬ future ܾ
+		void Stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock(_sleepMutex);
+				_stop.store(true);
+			}
+			_sleepCond.notify_all();
+			_threads.clear();
+
+			while (Job* job = FindJob(nullptr)) {
+				Execute(job);
+			}
+		}
+
+		//	ύ
+		template<typename F, typename... Args>
+		auto Submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>
+		{
+			using ResultT = std::invoke_result_t<F, Args...>;
+			std::packaged_task<ResultT()> task(
+				[func = std::forward<F>(f), ... captured_args = std::forward<Args>(args)]() mutable {
+					return std::invoke(func, captured_args...);
+				});
+
+			std::future<ResultT> result = task.get_future();
+			Enqueue(NewJob(std::move(task)));	//	packaged_task ֻһָ룬ţֻʣ״̬һη
+			return result;
+		}
+
+		//	ύҪԻ棬հţȶ״̬²ڴ
+		template<typename F, typename... Args>
+		void Post(F&& f, Args&&... args)
+		{
+			Enqueue(NewJob([func = std::forward<F>(f), ... captured_args = std::forward<Args>(args)]() mutable {
+				std::invoke(func, captured_args...);
+				}));
+		}
+
+		//	ֱͶѰװõ񣬲ٶΰװ
+		void Post(Task&& task)
+		{
+			Enqueue(NewJob(std::move(task)));
+		}
+
+		//	 Submit ͬسػ TaskFutureȶ״̬²ڴ
+		template<typename F, typename... Args>
+		auto SubmitPooled(F&& f, Args&&... args) -> TaskFuture<std::invoke_result_t<F, Args...>>
+		{
+			using ResultT = std::invoke_result_t<F, Args...>;
+			TaskState<ResultT>* state = TaskState<ResultT>::Create();
+			Enqueue(NewJob([state, func = std::forward<F>(f), ... captured_args = std::forward<Args>(args)]() mutable {
+				try {
+					if constexpr (std::is_void_v<ResultT>) {
+						std::invoke(func, captured_args...);
+						state->value.emplace();
+					}
+					else {
+						state->value.emplace(std::invoke(func, captured_args...));
+					}
+				}
+				catch (...) {
+					state->error = std::current_exception();
+				}
+				state->ready.store(true, std::memory_order_release);
+				TaskState<ResultT>::Release(state);
+				}));
+			return TaskFuture<ResultT>(state);
+		}
+
+		//	ȴ future ڼִге񣬿ڲöռ߳
+		template<typename R>
+		R Wait(std::future<R>& f)
+		{
+			while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				if (!RunPendingTask()) {
+					std::this_thread::yield();
+				}
+			}
+			return f.get();
+		}
+
+		template<typename R>
+		R Wait(TaskFuture<R>& f)
+		{
+			while (!f.is_ready())
+			{
+				if (!RunPendingTask()) {
+					std::this_thread::yield();
+				}
+			}
+			return f.get();
+		}
+
+		//	ڵǰִ߳һûʱfalse
+		bool RunPendingTask()
+		{
+			Job* job = FindJob(tls_pool == this ? tls_worker : nullptr);
+			if (!job) {
+				return false;
+			}
+			Execute(job);
+			return true;
+		}
+
+		uint32_t size() const noexcept
+		{
+			return static_cast<uint32_t>(_workers.size());
+		}
+
+		//	̰߳󶨵߼
+		const std::vector<uint32_t>& processors() const noexcept
+		{
+			return _processors;
+		}
+
+		//	̳߳߳أǹ߳ʱ nullptr
+		static WorkStealingPool* current() noexcept
+		{
+			return tls_pool;
+		}
+
+		WorkStealingPool(const WorkStealingPool&) = delete;
+		WorkStealingPool(WorkStealingPool&&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+		WorkStealingPool& operator=(WorkStealingPool&&) = delete;
+
+	private:
+
+		struct Job
+		{
+			Task fn;
+		};
+
+		struct alignas(64) Worker
+		{
+			explicit Worker(uint32_t i)
+				: index(i)
+				, rng(0x9E3779B97F4A7C15ull * (i + 1))
+			{
+			}
+
+			//	xorshift64ѡȡ
+			uint32_t next_random() noexcept
+			{
+				rng ^= rng << 13;
+				rng ^= rng >> 7;
+				rng ^= rng << 17;
+				return static_cast<uint32_t>(rng);
+			}
+
+			WorkStealingDeque<Job*> deque;
+			const uint32_t index;
+			uint64_t rng;
+		};
+
+		void Start(std::vector<uint32_t> processors)
+		{
+			_processors = std::move(processors);
+			const uint32_t count = static_cast<uint32_t>(_processors.size());
+			_workers.resize(count);
+			_ready = std::make_unique<std::latch>(count + 1);
+
+			_threads.reserve(count);
+			for (uint32_t i = 0; i < count; ++i) {
+				_threads.emplace_back(std::thread([this, i]() { WorkerLoop(i); }));
+			}
+			_ready->arrive_and_wait();		//	 Worker ɺܻȡ
+		}
+
+		template<typename F>
+		static Job* NewJob(F&& f)
+		{
+			Job* job = ObjectCache<Job>::Acquire();
+			job->fn = Task(std::forward<F>(f));
+			return job;
+		}
+
+		void Enqueue(Job* job)
+		{
+			if (tls_pool == this && tls_worker) {
+				tls_worker->deque.push(job);
+			}
+			else {
+				_injection.enqueue(job);
+			}
+			WakeOne();
+		}
+
+		Job* FindJob(Worker* self)
+		{
+			Job* job = nullptr;
+			if (self && self->deque.pop(job)) {
+				return job;
+			}
+
+			if (_injection.try_dequeue(job)) {
+				return job;
+			}
+
+			const uint32_t n = static_cast<uint32_t>(_workers.size());
+			const uint32_t start = self ? self->next_random() % n : 0;
+			for (uint32_t k = 0; k < n; ++k)
+			{
+				Worker* victim = _workers[(start + k) % n].get();
+				if (victim != self && victim->deque.steal(job)) {
+					return job;
+				}
+			}
+			return nullptr;
+		}
+
+		bool HasWork() const
+		{
+			if (_injection.size_approx() > 0) {
+				return true;
+			}
+			for (const auto& w : _workers) {
+				if (!w->deque.empty()) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		static void Execute(Job* job)
+		{
+			try {
+				job->fn();
+			}
+			catch (const std::exception& e) {
+				std::print("WorkStealingPool task exception : {}.\n", e.what());
+			}
+			job->fn.reset();
+			ObjectCache<Job>::Release(job);
+		}
+
+		void WorkerLoop(uint32_t index)
+		{
+			if (_processors[index] != kUnpinned) {
+				CpuTopology::Get().PinCurrentThread(_processors[index]);
+			}
+			//	󶨺ڱ̹߳ Worker˫˶ɱ߳״д룬״ηʲԷڱڵڴ
+			_workers[index] = std::make_unique<Worker>(index);
+			_ready->arrive_and_wait();
+
+			tls_pool = this;
+			tls_worker = _workers[index].get();
+			while (true)
+			{
+				if (Job* job = FindJob(tls_worker)) {
+					Execute(job);
+					continue;
+				}
+
+				if (_stop.load(std::memory_order_acquire)) {
+					break;
+				}
+				Park();
+			}
+			tls_pool = nullptr;
+			tls_worker = nullptr;
+		}
+
+		//	ȵǼΪ˯ٸУ WakeOne   -> ȡ˯ ˳ԣᶪʧ
+		void Park()
+		{
+			std::unique_lock<std::mutex> lock(_sleepMutex);
+			_sleepers.fetch_add(1, std::memory_order_seq_cst);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!HasWork() && !_stop.load())
+			{
+				_sleepCond.wait(lock, [this]() { return _wakeups > 0 || _stop.load(); });
+				if (_wakeups > 0) {
+					--_wakeups;
+				}
+			}
+			_sleepers.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		void WakeOne()
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (_sleepers.load(std::memory_order_seq_cst) == 0) [[likely]] {
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(_sleepMutex);
+				if (_wakeups >= _sleepers.load(std::memory_order_relaxed)) {
+					return;
+				}
+				++_wakeups;
+			}
+			_sleepCond.notify_one();
+		}
+
+		inline static thread_local WorkStealingPool* tls_pool = nullptr;
+		inline static thread_local Worker* tls_worker = nullptr;
+
+		std::vector<std::unique_ptr<Worker>> _workers;
+		std::vector<uint32_t> _processors;
+		std::unique_ptr<std::latch> _ready;
+		moodycamel::ConcurrentQueue<Job*> _injection;
+
+		alignas(64) std::atomic<uint32_t> _sleepers{ 0 };
+		uint32_t _wakeups{ 0 };				//	 _sleepMutex 
+		std::mutex _sleepMutex;
+		std::condition_variable _sleepCond;
+		std::atomic_bool _stop{ false };
+
+		std::vector<ThreadGuardJoin> _threads;
+	};
+
+	//	 NUMA ڵ㻮ֵ̳߳أÿڵһ WorkStealingPool̰߳ڱڵĴϣ
+	//	ȡֻڽڵڲʵɱڵ߳״дʱڴͬһڵ
+	class NumaPool
+	{
+	public:
+
+		//	threads_per_node Ϊ0ʱʹýڵȫ߼
+		//	û߼Ľڵ㣨ֻڴ棩أڵŰдĽڵ
+		explicit NumaPool(uint32_t threads_per_node = 0)
+		{
+			const CpuTopology& topology = CpuTopology::Get();
+			const std::vector<uint32_t> order = topology.Compact(0);
+			for (uint32_t node = 0; node < topology.nodes; ++node)
+			{
+				std::vector<uint32_t> local;
+				for (uint32_t id : order) {
+					if (topology.processors[id].node == node) {
+						local.push_back(id);
+					}
+				}
+				if (local.empty()) {
+					continue;
+				}
+
+				const uint32_t count = threads_per_node ? threads_per_node : static_cast<uint32_t>(local.size());
+				std::vector<uint32_t> processors(count);
+				for (uint32_t i = 0; i < count; ++i) {
+					processors[i] = local[i % local.size()];
+				}
+				_nodes.emplace_back(std::make_unique<WorkStealingPool>(std::move(processors)));
+			}
+
+			if (_nodes.empty()) {
+				_nodes.emplace_back(std::make_unique<WorkStealingPool>(threads_per_node));		//	̽ʧ
+			}
+		}
+
+		void Stop()
+		{
+			for (auto& pool : _nodes) {
+				pool->Stop();
+			}
+		}
+
+		uint32_t nodes() const noexcept
+		{
+			return static_cast<uint32_t>(_nodes.size());
+		}
+
+		WorkStealingPool& node(uint32_t n) noexcept
+		{
+			return *_nodes[n % _nodes.size()];
+		}
+
+		//	߳ڵĽڵ㣬ǱصĹ߳ʱ -1
+		int current_node() const noexcept
+		{
+			WorkStealingPool* pool = WorkStealingPool::current();
+			for (size_t i = 0; pool && i < _nodes.size(); ++i) {
+				if (_nodes[i].get() == pool) {
+					return static_cast<int>(i);
+				}
+			}
+			return -1;
+		}
+
+		uint32_t size() const noexcept
+		{
+			uint32_t total = 0;
+			for (const auto& pool : _nodes) {
+				total += pool->size();
+			}
+			return total;
+		}
+
+		//	ύָڵ
+		template<typename F, typename... Args>
+		auto SubmitTo(uint32_t n, F&& f, Args&&... args)
+		{
+			return node(n).Submit(std::forward<F>(f), std::forward<Args>(args)...);
+		}
+
+		template<typename F, typename... Args>
+		void PostTo(uint32_t n, F&& f, Args&&... args)
+		{
+			node(n).Post(std::forward<F>(f), std::forward<Args>(args)...);
+		}
+
+		//	δָڵ㣺߳ύڱڵ㣬ⲿ߳䵽ڵ
+		template<typename F, typename... Args>
+		auto Submit(F&& f, Args&&... args)
+		{
+			return node(PickNode()).Submit(std::forward<F>(f), std::forward<Args>(args)...);
+		}
+
+		template<typename F, typename... Args>
+		void Post(F&& f, Args&&... args)
+		{
+			node(PickNode()).Post(std::forward<F>(f), std::forward<Args>(args)...);
+		}
+
+		NumaPool(const NumaPool&) = delete;
+		NumaPool& operator=(const NumaPool&) = delete;
+
+	private:
+
+		uint32_t PickNode() noexcept
+		{
+			const int n = current_node();
+			return n >= 0 ? static_cast<uint32_t>(n) : _next.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		std::vector<std::unique_ptr<WorkStealingPool>> _nodes;
+		std::atomic<uint32_t> _next{ 0 };
+	};
+
+	//	ֲʱ֣ 0  256 ۣ 1~4  64 ۣ 2^32  tick1ms ʱԼ 49 죩
+	//	ԶĶʱȷ߲㣬ʱʣʱ·
+	//	Ϊ˫롢ȡ O(1)ͲתһȦʱŰѸ߲ӦĲۼÿ tick ֻһ
+	//	ʱ̰߳ĵʱߣڻصͶݵ WorkStealingPool ִ
+	class TimerWheel
+	{
+	public:
+
+		using Task = MoveOnlyTask;
+		using Clock = std::chrono::steady_clock;
+		using TimerId = uint64_t;		//	 32 λΪ 32 λΪڵ±ꣻڵ㸴ú id ʧЧ0 ΪЧ id
+
+		explicit TimerWheel(WorkStealingPool& pool, Clock::duration tick = std::chrono::milliseconds(1))
+			: _pool(pool)
+			, _tick(tick)
+			, _start(Clock::now())
+		{
+			std::fill(std::begin(_heads), std::end(_heads), kNil);
+			_threads.emplace_back(std::thread([this]() { TimerLoop(); }));
+		}
+
+		~TimerWheel()
+		{
+			if (!_stop) {
+				Stop();
+			}
+		}
+
+		inline static TimerWheel& instance() noexcept
+		{
+			static TimerWheel sWheel(WorkStealingPool::instance());
+			return sWheel;
+		}
+
+		//	ֹͣʱ̣߳δڵĶʱٴ
+		void Stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_stop = true;
+			}
+			_cond.notify_all();
+			_threads.clear();
+		}
+
+		//	delay ִ֮УΪһ tickǰ
+		template<typename F, typename... Args>
+		TimerId schedule_after(Clock::duration delay, F&& f, Args&&... args)
+		{
+			return schedule_at(Clock::now() + delay, std::forward<F>(f), std::forward<Args>(args)...);
+		}
+
+		template<typename F, typename... Args>
+		TimerId schedule_at(Clock::time_point when, F&& f, Args&&... args)
+		{
+			return Add(DueTick(when), 0, Bind(std::forward<F>(f), std::forward<Args>(args)...));
+		}
+
+		//	ÿ period ִһΣ̶Ƶʣ״һں󣩣ֱ cancel
+		//	һλصδʱδصᲢִ
+		template<typename F, typename... Args>
+		TimerId schedule_every(Clock::duration period, F&& f, Args&&... args)
+		{
+			const uint64_t ticks = std::max<uint64_t>(1, DueTick(_start + period));
+			return Add(DueTick(Clock::now() + period), ticks, Bind(std::forward<F>(f), std::forward<Args>(args)...));
+		}
+
+		//	ȡδĶʱڶʱȡǷȡɹ
+		bool cancel(TimerId id)
+		{
+			const uint32_t index = static_cast<uint32_t>(id);
+			const uint32_t generation = static_cast<uint32_t>(id >> 32);
+			Task dropped;								//	ص
+			std::shared_ptr<Periodic> dropped_periodic;
+
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (index >= _size) {
+				return false;
+			}
+			Node& node = At(index);
+			if (node.generation != generation || node.slot == kNoSlot) {
+				return false;
+			}
+
+			Unlink(index);
+			dropped = std::move(node.fn);
+			dropped_periodic = std::move(node.periodic);
+			FreeNode(index);
+			--_count;
+			return true;
+		}
+
+		//	ȴĶʱ
+		size_t size() const
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			return _count;
+		}
+
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel& operator=(const TimerWheel&) = delete;
+
+	private:
+
+		static constexpr uint32_t kLevel0Bits = 8;
+		static constexpr uint32_t kLevelBits = 6;
+		static constexpr uint32_t kLevels = 5;
+		static constexpr uint32_t kLevel0Slots = 1u << kLevel0Bits;
+		static constexpr uint32_t kLevelSlots = 1u << kLevelBits;
+		static constexpr uint32_t kSlots = kLevel0Slots + (kLevels - 1) * kLevelSlots;
+		static constexpr uint64_t kMaxDelta = (1ull << (kLevel0Bits + kLevelBits * (kLevels - 1))) - 1;
+		static constexpr uint32_t kNil = UINT32_MAX;
+		static constexpr uint16_t kNoSlot = UINT16_MAX;
+		static constexpr uint32_t kChunkBits = 12;		//	ڵ㰴 4096 һ䣬ʱнڵ
+
+		struct Periodic
+		{
+			explicit Periodic(Task&& f) : fn(std::move(f)) {}
+
+			Task fn;
+			std::atomic_bool running{ false };
+		};
+
+		struct Node
+		{
+			uint64_t expires = 0;			//	 tick
+			uint64_t period = 0;			//	 tick0 Ϊһ
+			Task fn;
+			std::shared_ptr<Periodic> periodic;
+			uint32_t prev = kNil;
+			uint32_t next = kNil;			//	ʱΪһ
+			uint32_t generation = 1;
+			uint16_t slot = kNoSlot;		//	ڲۣkNoSlot ʾʱ
+		};
+
+		template<typename F, typename... Args>
+		static Task Bind(F&& f, Args&&... args)
+		{
+			return Task([func = std::forward<F>(f), ... captured_args = std::forward<Args>(args)]() mutable {
+				std::invoke(func, captured_args...);
+				});
+		}
+
+		//	ȡ֤ tick ߽粻 when
+		uint64_t DueTick(Clock::time_point when) const
+		{
+			if (when <= _start) {
+				return 0;
+			}
+			return static_cast<uint64_t>((when - _start + _tick - Clock::duration(1)) / _tick);
+		}
+
+		uint64_t CurrentTick() const
+		{
+			return static_cast<uint64_t>((Clock::now() - _start) / _tick);
+		}
+
+		Node& At(uint32_t index) noexcept
+		{
+			return _chunks[index >> kChunkBits][index & ((1u << kChunkBits) - 1)];
+		}
+
+		uint32_t AllocNode()
+		{
+			if (_freeHead != kNil) {
+				const uint32_t index = _freeHead;
+				_freeHead = At(index).next;
+				return index;
+			}
+			if (_size == (_chunks.size() << kChunkBits)) {
+				_chunks.emplace_back(std::make_unique<Node[]>(1u << kChunkBits));
+			}
+			return _size++;
+		}
+
+		void FreeNode(uint32_t index) noexcept
+		{
+			Node& node = At(index);
+			node.fn.reset();
+			node.periodic.reset();
+			++node.generation;
+			if (node.generation == 0) {
+				node.generation = 1;
+			}
+			node.next = _freeHead;
+			_freeHead = index;
+		}
+
+		TimerId Add(uint64_t due, uint64_t period, Task fn)
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			const uint32_t index = AllocNode();
+			Node& node = At(index);
+			node.expires = std::max(due, _now + 1);
+			node.period = period;
+			if (period) {
+				node.periodic = std::make_shared<Periodic>(std::move(fn));
+			}
+			else {
+				node.fn = std::move(fn);
+			}
+			Place(index);
+			++_count;
+
+			const TimerId id = (static_cast<uint64_t>(node.generation) << 32) | index;
+			const bool wake = node.expires < _wakeTick;
+			lock.unlock();
+			if (wake) {
+				_cond.notify_one();
+			}
+			return id;
+		}
+
+		//	ʣ tick ѡ㣺 0 Ϊ [0, 2^8) k Ϊ [2^(8+6(k-1)), 2^(8+6k))
+		void Place(uint32_t index) noexcept
+		{
+			Node& node = At(index);
+			const uint64_t delta = std::min(node.expires - _now, kMaxDelta);
+			const uint64_t due = _now + delta;
+
+			uint32_t slot;
+			if (delta < kLevel0Slots) {
+				slot = static_cast<uint32_t>(due & (kLevel0Slots - 1));
+			}
+			else {
+				uint32_t level = 1;
+				while (delta >= (1ull << (kLevel0Bits + kLevelBits * level))) {
+					++level;
+				}
+				const uint32_t shift = kLevel0Bits + kLevelBits * (level - 1);
+				slot = kLevel0Slots + (level - 1) * kLevelSlots + static_cast<uint32_t>((due >> shift) & (kLevelSlots - 1));
+			}
+
+			node.slot = static_cast<uint16_t>(slot);
+			node.prev = kNil;
+			node.next = _heads[slot];
+			if (node.next != kNil) {
+				At(node.next).prev = index;
+			}
+			_heads[slot] = index;
+			_occupied[slot >> 6] |= 1ull << (slot & 63);
+		}
+
+		void Unlink(uint32_t index) noexcept
+		{
+			Node& node = At(index);
+			if (node.prev != kNil) {
+				At(node.prev).next = node.next;
+			}
+			else {
+				_heads[node.slot] = node.next;
+				if (node.next == kNil) {
+					_occupied[node.slot >> 6] &= ~(1ull << (node.slot & 63));
+				}
+			}
+			if (node.next != kNil) {
+				At(node.next).prev = node.prev;
+			}
+			node.slot = kNoSlot;
+		}
+
+		//	ȡ
+		uint32_t Detach(uint32_t slot) noexcept
+		{
+			const uint32_t head = _heads[slot];
+			_heads[slot] = kNil;
+			_occupied[slot >> 6] &= ~(1ull << (slot & 63));
+			return head;
+		}
+
+		void Cascade(uint32_t slot) noexcept
+		{
+			for (uint32_t index = Detach(slot); index != kNil;) {
+				const uint32_t next = At(index).next;
+				Place(index);
+				index = next;
+			}
+		}
+
+		void Expire(uint32_t slot)
+		{
+			for (uint32_t index = Detach(slot); index != kNil;)
+			{
+				Node& node = At(index);
+				const uint32_t next = node.next;
+				node.slot = kNoSlot;
+				if (node.expires > _now) {
+					Place(index);				//	ΧضϵԶڶʱ
+				}
+				else if (node.period == 0) {
+					_fired.push_back(std::move(node.fn));
+					FreeNode(index);
+					--_count;
+				}
+				else {
+					_fired.push_back(Task([periodic = node.periodic]() {
+						if (periodic->running.exchange(true, std::memory_order_acquire)) {
+							return;
+						}
+						try {
+							periodic->fn();
+						}
+						catch (...) {
+							periodic->running.store(false, std::memory_order_release);
+							throw;
+						}
+						periodic->running.store(false, std::memory_order_release);
+						}));
+					node.expires += node.period;
+					Place(index);
+				}
+				index = next;
+			}
+		}
+
+		//	 tick ƽ 0 תһȦʱμ 1 㡢 2 㡭ĵǰۣٴ 0 ĵǰ
+		void AdvanceTo(uint64_t target)
+		{
+			while (_now < target)
+			{
+				if (_count == 0) {
+					_now = target;				//	ûжʱʱֱ
+					break;
+				}
+
+				++_now;
+				const uint32_t index0 = static_cast<uint32_t>(_now & (kLevel0Slots - 1));
+				if (index0 == 0) {
+					for (uint32_t level = 1; level < kLevels; ++level) {
+						const uint32_t shift = kLevel0Bits + kLevelBits * (level - 1);
+						const uint32_t index = static_cast<uint32_t>((_now >> shift) & (kLevelSlots - 1));
+						Cascade(kLevel0Slots + (level - 1) * kLevelSlots + index);
+						if (index != 0) {
+							break;
+						}
+					}
+				}
+				Expire(index0);
+			}
+		}
+
+		//	 0 һǿղۣȦûʱص 0 תһȦ tickҪ
+		uint64_t NextExpiry() const noexcept
+		{
+			const uint32_t current = static_cast<uint32_t>(_now & (kLevel0Slots - 1));
+			for (uint32_t i = current + 1; i < kLevel0Slots;)
+			{
+				const uint64_t bits = _occupied[i >> 6] >> (i & 63);
+				if (bits) {
+					return _now + (i + std::countr_zero(bits) - current);
+				}
+				i = ((i >> 6) + 1) << 6;
+			}
+			return (_now | (kLevel0Slots - 1)) + 1;
+		}
+
+		void TimerLoop()
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			while (!_stop)
+			{
+				AdvanceTo(CurrentTick());
+				if (!_fired.empty())
+				{
+					_dispatch.swap(_fired);
+					_wakeTick = 0;				//	Ͷڼ¼ĶʱҪ
+					lock.unlock();
+					for (auto& task : _dispatch) {
+						_pool.Post(std::move(task));
+					}
+					_dispatch.clear();
+					lock.lock();
+					continue;
+				}
+
+				if (_count == 0) {
+					_wakeTick = UINT64_MAX;
+					_cond.wait(lock);
+				}
+				else {
+					_wakeTick = NextExpiry();
+					_cond.wait_until(lock, _start + _tick * static_cast<Clock::rep>(_wakeTick));
+				}
+			}
+		}
+
+		WorkStealingPool& _pool;
+		const Clock::duration _tick;
+		const Clock::time_point _start;
+
+		mutable std::mutex _mutex;
+		std::condition_variable _cond;
+		bool _stop = false;
+		uint64_t _now = 0;					//	Ѵ tick
+		uint64_t _wakeTick = 0;				//	ʱ̼߳ƻ tickĶʱʱҪ
+		size_t _count = 0;
+
+		uint32_t _heads[kSlots];
+		uint64_t _occupied[kSlots / 64] = {};
+		std::vector<std::unique_ptr<Node[]>> _chunks;
+		uint32_t _size = 0;
+		uint32_t _freeHead = kNil;
+
+		std::vector<Task> _fired;			//	ֵڵĻص
+		std::vector<Task> _dispatch;		//	ͶеĻص
+
+		std::vector<ThreadGuardJoin> _threads;
+	};
+
+	//	ͼDAGִڵǰȫɵĽڵűȣκι̶߳ȴ
+	//	ڵɺݼ̵ļһĺڵǰִ̼߳УͶݵ
+	//	ͼṹִ״̬룬ظֻü·䣻ͬһͼܲ
+	//	Pool Ҫṩ Post ThreadPoolWorkStealingPool
+	class TaskGraph
+	{
+	public:
+
+		using NodeId = uint32_t;
+
+		TaskGraph() = default;
+
+		template<typename F>
+		NodeId Emplace(F&& f)
+		{
+			_nodes.emplace_back(std::make_unique<Node>(std::function<void()>(std::forward<F>(f))));
+			_validated = false;
+			return static_cast<NodeId>(_nodes.size() - 1);
 		}
 
-		void Stop()
+		//	after  before ִ֮
+		void Precede(NodeId before, NodeId after)
 		{
-			_stop.store(true);
-			_condition.notify_all();
-			_threads.clear();
+			if (before >= _nodes.size() || after >= _nodes.size() || before == after) {
+				throw std::invalid_argument("TaskGraph::Precede invalid node");
+			}
+			_nodes[before]->successors.push_back(after);
+			++_nodes[after]->indegree;
+			_validated = false;
+		}
 
-			if (!_tasks.empty())
-				std::print("ThreadPool Stop _tasks size : {}.\n", _tasks.size());
+		void Clear()
+		{
+			_nodes.clear();
+			_roots.clear();
+			_validated = false;
 		}
 
-		//	ύ
-		template<typename F, typename... Args>
-		auto Submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>
+		size_t size() const noexcept
 		{
-			using ResultT = std::invoke_result_t<F, Args...>;
-			auto task = std::make_shared<std::packaged_task<ResultT()>>(
-				[func = std::forward<F>(f), ... captured_args = std::forward<Args>(args)]() {
-					return std::invoke(func, captured_args...);
-				});
+			return _nodes.size();
+		}
 
-			bool wasEmpty = false;
-			std::future<ResultT> result = task->get_future();
-			{
-				std::lock_guard<std::mutex> lock(_mutex);
-				wasEmpty = _tasks.empty();
-				_tasks.emplace([task]() { (*task)(); }); // 񵽶
+		//	ͼȴɣ WorkStealingPool ߳ϵʱȴڼִге
+		//	ڵ׳쳣ʱδʼĽڵ㲻ִУRun ׳һ쳣
+		template<typename Pool>
+		void Run(Pool& pool)
+		{
+			if (_running.exchange(true)) {
+				throw std::logic_error("TaskGraph is already running");
+			}
+			if (!_validated) {
+				try {
+					Validate();
+				}
+				catch (...) {
+					_running.store(false);
+					throw;
+				}
+			}
+			if (_nodes.empty()) {
+				_running.store(false);
+				return;
 			}
 
-			if (_waiting_workers > 0 && wasEmpty) {
-				_condition.notify_one();
+			for (auto& node : _nodes) {
+				node->pending.store(node->indegree, std::memory_order_relaxed);
 			}
+			_error = nullptr;
+			_failed.store(false, std::memory_order_relaxed);
+			_finished = false;
+			_remaining.store(static_cast<uint32_t>(_nodes.size()), std::memory_order_release);
 
-			return result;
+			for (NodeId root : _roots) {
+				Node* node = _nodes[root].get();
+				pool.Post([this, &pool, node]() { Execute(pool, node); });
+			}
+
+			if constexpr (requires { pool.RunPendingTask(); }) {
+				while (_remaining.load(std::memory_order_acquire) != 0) {
+					if (!pool.RunPendingTask()) {
+						std::this_thread::yield();
+					}
+				}
+			}
+
+			//	ɵĽڵ _finishedȴõʱԷѲٷʱ
+			{
+				std::unique_lock<std::mutex> lock(_doneMutex);
+				_doneCond.wait(lock, [this]() { return _finished; });
+			}
+			_running.store(false);
+
+			if (_error) {
+				std::rethrow_exception(_error);
+			}
 		}
 
-		ThreadPool(const ThreadPool&) = delete;
-		ThreadPool(ThreadPool&&) = delete;
-		ThreadPool& operator=(const ThreadPool&) = delete;
-		ThreadPool& operator=(ThreadPool&&) = delete;
+		TaskGraph(const TaskGraph&) = delete;
+		TaskGraph& operator=(const TaskGraph&) = delete;
 
 	private:
 
-		ThreadPool()
+		struct Node
 		{
-			//	ͨûȡ߳
-			//	...
-			using namespace std::chrono_literals;
-			const int num_cpu = std::max(1u, std::thread::hardware_concurrency()) / 2;
-			_threads.reserve(num_cpu);
-			_stop.store(false);
+			explicit Node(std::function<void()>&& f) : work(std::move(f)) {}
 
-			for (int i = 0; i < num_cpu; i++)
+			std::function<void()> work;
+			std::vector<NodeId> successors;
+			uint32_t indegree = 0;
+			std::atomic<uint32_t> pending{ 0 };		//	δɵǰ
+		};
+
+		//	Kahn 黷ͬʱռΪ 0 ĸڵ
+		void Validate()
+		{
+			std::vector<uint32_t> indegree(_nodes.size());
+			std::vector<NodeId> ready;
+			_roots.clear();
+			for (NodeId i = 0; i < _nodes.size(); ++i) {
+				indegree[i] = _nodes[i]->indegree;
+				if (indegree[i] == 0) {
+					_roots.push_back(i);
+					ready.push_back(i);
+				}
+			}
+
+			size_t visited = 0;
+			while (!ready.empty())
 			{
-				_threads.emplace_back(std::thread([this]() {
-					while (true)
-					{
-						Task task;
-						{
-							std::unique_lock<std::mutex> lock(_mutex);
-							++_waiting_workers;
-							_condition.wait(lock, [this]() {
-								return _stop.load() || !_tasks.empty();
-								});
-
-							if (_stop.load())
-								return;
-
-							--_waiting_workers;
-							task = std::move(_tasks.front());
-							_tasks.pop();
+				const NodeId id = ready.back();
+				ready.pop_back();
+				++visited;
+				for (NodeId s : _nodes[id]->successors) {
+					if (--indegree[s] == 0) {
+						ready.push_back(s);
+					}
+				}
+			}
+			if (visited != _nodes.size()) {
+				throw std::logic_error("TaskGraph contains a cycle");
+			}
+			_validated = true;
+		}
+
+		template<typename Pool>
+		void Execute(Pool& pool, Node* node)
+		{
+			while (node)
+			{
+				if (!_failed.load(std::memory_order_relaxed))
+				{
+					try {
+						node->work();
+					}
+					catch (...) {
+						if (!_failed.exchange(true)) {
+							_error = std::current_exception();
 						}
+					}
+				}
 
-						try {
-							task();
+				Node* next = nullptr;
+				for (NodeId s : node->successors)
+				{
+					Node* successor = _nodes[s].get();
+					if (successor->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					{
+						if (!next) {
+							next = successor;		//	͵ؼʡȥһӺȡ
 						}
-						catch (const std::exception& e) {
-							std::print("ThreadPool task exception : {}.\n", e.what());
+						else {
+							pool.Post([this, &pool, successor]() { Execute(pool, successor); });
 						}
 					}
-					}));
+				}
+
+				if (_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					std::lock_guard<std::mutex> lock(_doneMutex);
+					_finished = true;
+					_doneCond.notify_all();
+				}
+				node = next;
 			}
 		}
 
-		~ThreadPool()
+		std::vector<std::unique_ptr<Node>> _nodes;
+		std::vector<NodeId> _roots;
+		bool _validated = false;
+
+		std::atomic_bool _running{ false };
+		std::atomic_bool _failed{ false };
+		std::exception_ptr _error;				//	ɵһʧܵĽڵд룬Run ɺȡ
+		alignas(64) std::atomic<uint32_t> _remaining{ 0 };
+
+		std::mutex _doneMutex;
+		std::condition_variable _doneCond;
+		bool _finished = false;
+	};
+
+	//	㷨 fork/joinҰύСڵǰִ߳Уȴڼִге
+	//	˿ڳڲǶ׵ö
+	//	ӦȳʼΪ log2(߳)+3ÿ߳Լ 8 飩鱻߳ȡ˵߳̿У
+	//	ȡָȼϸ֣grain ΪС
+
+	//	ҰύУڵǰִ߳У׳쳣ʱҲȵҰɣҰŵջϵ
+	template<typename Right, typename Left>
+	static auto ForkJoin(WorkStealingPool& pool, Right&& right, Left&& left)
+	{
+		auto future = pool.SubmitPooled(std::forward<Right>(right));
+		try {
+			if constexpr (std::is_void_v<std::invoke_result_t<Left&>>) {
+				left();
+				pool.Wait(future);
+			}
+			else {
+				auto l = left();
+				auto r = pool.Wait(future);
+				return std::pair(std::move(l), std::move(r));
+			}
+		}
+		catch (...) {
+			if (future.valid()) {
+				try { pool.Wait(future); }
+				catch (...) {}
+			}
+			throw;
+		}
+	}
+
+	template<typename Index, typename Leaf, typename Join>
+	struct RangeContext
+	{
+		WorkStealingPool& pool;
+		Index grain;
+		uint32_t depth;
+		Leaf& leaf;
+		Join& join;
+	};
+
+	static uint32_t SplitDepth(const WorkStealingPool& pool) noexcept
+	{
+		return static_cast<uint32_t>(std::bit_width(pool.size())) + 3;
+	}
+
+	template<typename Index, typename Leaf, typename Join>
+	static auto ForkJoinRange(const RangeContext<Index, Leaf, Join>& ctx, Index begin, Index end, uint32_t depth)
+		-> std::invoke_result_t<Leaf&, Index, Index>
+	{
+		if (depth == 0 || end - begin <= ctx.grain) {
+			return ctx.leaf(begin, end);
+		}
+
+		const Index mid = begin + (end - begin) / 2;
+		const std::thread::id owner = std::this_thread::get_id();
+		auto right = [&ctx, mid, end, depth, owner]() {
+			return ForkJoinRange(ctx, mid, end, std::this_thread::get_id() != owner ? ctx.depth : depth - 1);
+		};
+		auto left = [&ctx, begin, mid, depth]() {
+			return ForkJoinRange(ctx, begin, mid, depth - 1);
+		};
+
+		if constexpr (std::is_void_v<std::invoke_result_t<Leaf&, Index, Index>>) {
+			ForkJoin(ctx.pool, right, left);
+		}
+		else {
+			auto [l, r] = ForkJoin(ctx.pool, right, left);
+			return ctx.join(std::move(l), std::move(r));
+		}
+	}
+
+	//	 [begin, end) еÿ± fn(i)
+	template<typename Index, typename F>
+	static void parallel_for(WorkStealingPool& pool, Index begin, Index end, F&& fn, Index grain = 1)
+	{
+		static_assert(std::is_integral_v<Index>, "parallel_for requires an integral index");
+		if (begin >= end) {
+			return;
+		}
+
+		auto leaf = [&fn](Index b, Index e) {
+			for (Index i = b; i < e; ++i) {
+				fn(i);
+			}
+		};
+		auto join = []() {};
+		const RangeContext<Index, decltype(leaf), decltype(join)> ctx{ pool, std::max<Index>(grain, 1), SplitDepth(pool), leaf, join };
+		ForkJoinRange(ctx, begin, end, ctx.depth);
+	}
+
+	//	d_first[i] = op(first[i])ĩβ
+	template<typename InIt, typename OutIt, typename UnaryOp>
+	static OutIt parallel_transform(WorkStealingPool& pool, InIt first, InIt last, OutIt d_first, UnaryOp op, size_t grain = 1)
+	{
+		const size_t n = static_cast<size_t>(last - first);
+		parallel_for(pool, size_t(0), n, [&](size_t i) { d_first[i] = op(first[i]); }, grain);
+		return d_first + n;
+	}
+
+	//	op ɣҪ󽻻ɣ鰴˳ϲ std::accumulate һ
+	template<typename It, typename T, typename BinaryOp = std::plus<>>
+	static T parallel_reduce(WorkStealingPool& pool, It first, It last, T init, BinaryOp op = {}, size_t grain = 1)
+	{
+		const size_t n = static_cast<size_t>(last - first);
+		if (n == 0) {
+			return init;
+		}
+
+		auto leaf = [&](size_t b, size_t e) {
+			T acc = first[b];
+			for (size_t i = b + 1; i < e; ++i) {
+				acc = op(std::move(acc), first[i]);
+			}
+			return acc;
+		};
+		auto join = [&op](T l, T r) { return op(std::move(l), std::move(r)); };
+		const RangeContext<size_t, decltype(leaf), decltype(join)> ctx{ pool, std::max<size_t>(grain, 1), SplitDepth(pool), leaf, join };
+		return op(std::move(init), ForkJoinRange(ctx, size_t(0), n, ctx.depth));
+	}
+
+	//	ȶĲй鲢ϳһеһ࣬벢й鲢 out
+	template<typename It, typename OutIt, typename Compare>
+	static void ParallelMerge(WorkStealingPool& pool, It a1, It a2, It b1, It b2, OutIt out, size_t cutoff, Compare& comp)
+	{
+		const size_t na = static_cast<size_t>(a2 - a1);
+		const size_t nb = static_cast<size_t>(b2 - b1);
+		if (na + nb <= cutoff) {
+			std::merge(std::make_move_iterator(a1), std::make_move_iterator(a2), std::make_move_iterator(b1), std::make_move_iterator(b2), out, comp);
+			return;
+		}
+
+		It am, bm;
+		if (na >= nb) {
+			am = a1 + na / 2;
+			bm = std::lower_bound(b1, b2, *am, comp);		//	b ϸС *am 
+		}
+		else {
+			bm = b1 + nb / 2;
+			am = std::upper_bound(a1, a2, *bm, comp);		//	a в *bm 
+		}
+		OutIt om = out + (am - a1) + (bm - b1);
+		ForkJoin(pool,
+			[&pool, am, a2, bm, b2, om, cutoff, &comp]() { ParallelMerge(pool, am, a2, bm, b2, om, cutoff, comp); },
+			[&pool, a1, am, b1, bm, out, cutoff, &comp]() { ParallelMerge(pool, a1, am, b1, bm, out, cutoff, comp); });
+	}
+
+	template<typename It, typename BufIt, typename Compare>
+	static void MergeSort(WorkStealingPool& pool, It first, It last, BufIt buffer, size_t cutoff, Compare& comp)
+	{
+		const size_t n = static_cast<size_t>(last - first);
+		if (n <= cutoff) {
+			std::stable_sort(first, last, comp);
+			return;
+		}
+
+		const It mid = first + n / 2;
+		ForkJoin(pool,
+			[&pool, mid, last, buffer, n, cutoff, &comp]() { MergeSort(pool, mid, last, buffer + n / 2, cutoff, comp); },
+			[&pool, first, mid, buffer, cutoff, &comp]() { MergeSort(pool, first, mid, buffer, cutoff, comp); });
+
+		ParallelMerge(pool, first, mid, mid, last, buffer, cutoff, comp);
+		parallel_for(pool, size_t(0), n, [first, buffer](size_t i) { first[i] = std::move(buffer[i]); }, cutoff);
+	}
+
+	//	й鲢ȶҪ n Ԫصʱ壬ԪĬϹ
+	template<typename It, typename Compare = std::less<>>
+	static void parallel_sort(WorkStealingPool& pool, It first, It last, Compare comp = {})
+	{
+		const size_t n = static_cast<size_t>(last - first);
+		const size_t cutoff = std::max<size_t>(4096, n / (pool.size() * 8ull));
+		if (n <= cutoff) {
+			std::stable_sort(first, last, comp);
+			return;
+		}
+
+		std::vector<typename std::iterator_traits<It>::value_type> buffer(n);
+		MergeSort(pool, first, last, buffer.begin(), cutoff, comp);
+	}
+
+	static uint64_t FibSerial(uint32_t n)
+	{
+		return n < 2 ? n : FibSerial(n - 1) + FibSerial(n - 2);
+	}
+
+	//	fork/joinn-1 Ϊύn-2 ڵǰ̼߳㣬cutoff ´
+	static uint64_t FibParallel(WorkStealingPool& pool, uint32_t n, uint32_t cutoff)
+	{
+		if (n <= cutoff) {
+			return FibSerial(n);
+		}
+
+		auto left = pool.Submit(FibParallel, std::ref(pool), n - 1, cutoff);
+		const uint64_t right = FibParallel(pool, n - 2, cutoff);
+		return pool.Wait(left) + right;
+	}
+
+	//	ϸ£ⲿ߳ύ count 񲢵ȴȫ
+	template<typename Pool>
+	static void FineGrainedBench(const char* name, Pool& pool, uint32_t count)
+	{
+		std::atomic<uint32_t> done{ 0 };
+		std::vector<std::future<void>> futures;
+		futures.reserve(count);
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < count; ++i) {
+			futures.push_back(pool.Submit([&done]() { done.fetch_add(1, std::memory_order_relaxed); }));
+		}
+		for (auto& f : futures) {
+			f.wait();
+		}
+		auto end_time = std::chrono::high_resolution_clock::now();
+
+		const auto us = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+		std::print("{} fine grained {} tasks, done {}, use {}ms, {:.2f} Mtasks/s.\n", name, count, done.load(), us / 1000,
+			us > 0 ? static_cast<double>(count) / us : 0.0);
+	}
+
+	//	ÿڵɱڵ̷ֿ߳״д룬ٷֱ𽻸ڵ㣨localһڵ㣨remote̷ֿ߳
+	static void NumaLocalityBench(NumaPool& pool, size_t elements_per_node, uint32_t passes)
+	{
+		const uint32_t nodes = pool.nodes();
+		std::vector<std::unique_ptr<uint64_t[]>> data(nodes);
+		auto for_chunks = [&](uint32_t owner, uint32_t runner, auto&& fn) {
+			const size_t chunks = pool.node(runner).size() * 4ull;
+			const size_t step = (elements_per_node + chunks - 1) / chunks;
+			std::vector<std::future<uint64_t>> futures;
+			for (size_t begin = 0; begin < elements_per_node; begin += step) {
+				const size_t end = std::min(elements_per_node, begin + step);
+				futures.push_back(pool.SubmitTo(runner, [&fn, p = data[owner].get(), begin, end]() { return fn(p, begin, end); }));
+			}
+			uint64_t total = 0;
+			for (auto& f : futures) {
+				total += f.get();
+			}
+			return total;
+		};
+
+		for (uint32_t n = 0; n < nodes; ++n) {
+			data[n].reset(new uint64_t[elements_per_node]);		//	δʼҳ״дʱŷ
+			for_chunks(n, n, [](uint64_t* p, size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					p[i] = i;
+				}
+				return uint64_t(0);
+				});
+		}
+
+		auto sum = [](uint64_t* p, size_t begin, size_t end) {
+			uint64_t s = 0;
+			for (size_t i = begin; i < end; ++i) {
+				s += p[i];
+			}
+			return s;
+		};
+		for (uint32_t offset : { 0u, 1u })
 		{
-			if (!_stop.load())
-				Stop();
+			uint64_t checksum = 0;
+			auto start_time = std::chrono::high_resolution_clock::now();
+			for (uint32_t pass = 0; pass < passes; ++pass) {
+				for (uint32_t n = 0; n < nodes; ++n) {
+					checksum += for_chunks(n, (n + offset) % nodes, sum);
+				}
+			}
+			auto end_time = std::chrono::high_resolution_clock::now();
+			const auto us = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+			const double bytes = static_cast<double>(elements_per_node) * sizeof(uint64_t) * nodes * passes;
+			std::print("NumaPool {} access {} node(s), checksum {}, use {}ms, {:.2f} GB/s.\n", offset ? "remote" : "local ", nodes,
+				checksum, us / 1000, us > 0 ? bytes / us / 1000.0 : 0.0);
 		}
+	}
 
-		std::atomic_bool _stop{ true };
-		std::uint32_t _waiting_workers{ 0 };
-		std::vector<ThreadGuardJoin> _threads;
+	//	threads ߳¸㷨ĺʱ봮а汾Ա
+	static void ParallelScalingBench(uint32_t threads, size_t n)
+	{
+		WorkStealingPool pool(threads);
+		std::vector<uint32_t> data(n);
+		uint64_t seed = 0x9E3779B97F4A7C15ull;
+		for (auto& v : data) {
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			v = static_cast<uint32_t>(seed);
+		}
 
-		std::mutex _mutex;
-		std::condition_variable _condition;
-		std::queue<Task> _tasks;	//	Ӧʹ̰߳ȫĶ
-	};
+		auto measure = [](auto&& fn) {
+			auto start_time = std::chrono::high_resolution_clock::now();
+			fn();
+			auto end_time = std::chrono::high_resolution_clock::now();
+			return std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+		};
+
+		std::vector<double> out(n);
+		auto heavy = [](uint32_t v) {
+			double x = v;
+			for (int k = 0; k < 16; ++k) {
+				x = std::sqrt(x + k);
+			}
+			return x;
+		};
+
+		const double for_ms = measure([&]() {
+			parallel_for(pool, size_t(0), n, [&](size_t i) { out[i] = heavy(data[i]); });
+			});
+		uint64_t sum = 0;
+		const double reduce_ms = measure([&]() {
+			sum = parallel_reduce(pool, data.begin(), data.end(), uint64_t(0), [](uint64_t a, uint64_t b) { return a + b; });
+			});
+		const double transform_ms = measure([&]() {
+			parallel_transform(pool, data.begin(), data.end(), out.begin(), heavy);
+			});
+
+		std::vector<uint32_t> sorted = data;
+		const double sort_ms = measure([&]() {
+			parallel_sort(pool, sorted.begin(), sorted.end());
+			});
+
+		const bool ok = sum == std::accumulate(data.begin(), data.end(), uint64_t(0)) && std::is_sorted(sorted.begin(), sorted.end());
+		std::print("parallel {:>2} threads {} elements : for {:.1f}ms, reduce {:.1f}ms, transform {:.1f}ms, sort {:.1f}ms, {}.\n",
+			threads, n, for_ms, reduce_ms, transform_ms, sort_ms, ok ? "ok" : "WRONG");
+	}
+
+	//	ͼ1 Դ -> width ڵ -> 1 㣻ͼdepth ڵֲͼÿڵһڵڵ
+	//	״а飬֮ظͬһͼֲͼύ future ٵȴдԱ
+	template<typename Pool>
+	static void TaskGraphBench(const char* pool_name, Pool& pool)
+	{
+		std::atomic<uint64_t> executed{ 0 };
+		auto body = [&executed]() { executed.fetch_add(1, std::memory_order_relaxed); };
+
+		auto bench = [&](const char* name, TaskGraph& graph, uint32_t runs) {
+			executed = 0;
+			auto start_time = std::chrono::high_resolution_clock::now();
+			graph.Run(pool);
+			auto mid_time = std::chrono::high_resolution_clock::now();
+			for (uint32_t r = 0; r < runs; ++r) {
+				graph.Run(pool);
+			}
+			auto end_time = std::chrono::high_resolution_clock::now();
+
+			const auto first_us = std::chrono::duration_cast<std::chrono::microseconds>(mid_time - start_time).count();
+			const auto rerun_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - mid_time).count() / runs;
+			std::print("TaskGraph {} {} {} nodes : first run {}us, re-run {}us ({}ns/node), executed {}.\n", pool_name, name, graph.size(),
+				first_us, rerun_ns / 1000, rerun_ns / graph.size(), executed.load());
+		};
+
+		constexpr uint32_t width = 10'000;
+		constexpr uint32_t depth = 10'000;
+		constexpr uint32_t layers = 100;
+		constexpr uint32_t runs = 10;
+		{
+			TaskGraph graph;
+			const auto source = graph.Emplace(body);
+			const auto sink = graph.Emplace(body);
+			for (uint32_t i = 0; i < width; ++i) {
+				const auto node = graph.Emplace(body);
+				graph.Precede(source, node);
+				graph.Precede(node, sink);
+			}
+			bench("wide   ", graph, runs);
+		}
+		{
+			TaskGraph graph;
+			auto prev = graph.Emplace(body);
+			for (uint32_t i = 1; i < depth; ++i) {
+				const auto node = graph.Emplace(body);
+				graph.Precede(prev, node);
+				prev = node;
+			}
+			bench("deep   ", graph, runs);
+		}
+		{
+			TaskGraph graph;
+			std::vector<TaskGraph::NodeId> prev, cur;
+			for (uint32_t l = 0; l < layers; ++l) {
+				cur.clear();
+				for (uint32_t i = 0; i < width / layers; ++i) {
+					cur.push_back(graph.Emplace(body));
+					if (!prev.empty()) {
+						graph.Precede(prev[i], cur.back());
+						graph.Precede(prev[(i + 1) % prev.size()], cur.back());
+					}
+				}
+				prev.swap(cur);
+			}
+			bench("layered", graph, runs);
+
+			executed = 0;
+			auto start_time = std::chrono::high_resolution_clock::now();
+			for (uint32_t r = 0; r < runs; ++r) {
+				for (uint32_t l = 0; l < layers; ++l) {
+					std::vector<std::future<void>> futures;
+					futures.reserve(width / layers);
+					for (uint32_t i = 0; i < width / layers; ++i) {
+						futures.push_back(pool.Submit(body));
+					}
+					for (auto& f : futures) {
+						f.get();
+					}
+				}
+			}
+			auto end_time = std::chrono::high_resolution_clock::now();
+			std::print("TaskGraph {} layered by future barrier : {}us per run, executed {}.\n", pool_name,
+				std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / runs, executed.load());
+		}
+	}
 
 	void Test() override
 	{
@@ -303,6 +2496,261 @@ public:
 			}, 1001);
 
 		std::print("ThreadPool test result : {}.\n", taskres.get());	//	get() ȴִн
+
+		{
+			//	ȡ̳߳뵥̳߳ضԱ
+			constexpr uint32_t task_count = 200'000;
+			WorkStealingPool ws_pool;
+			FineGrainedBench("ThreadPool      ", ThreadPool::instance(), task_count);
+			FineGrainedBench("WorkStealingPool", ws_pool, task_count);
+
+			//	fork/join 쳲ThreadPool и get() ϻռ̣߳ݹȳֻ߳봮жԱ
+			constexpr uint32_t fib_n = 30;
+			auto start_time = std::chrono::high_resolution_clock::now();
+			const uint64_t serial = FibSerial(fib_n);
+			auto mid_time = std::chrono::high_resolution_clock::now();
+			const uint64_t parallel = FibParallel(ws_pool, fib_n, 12);
+			auto end_time = std::chrono::high_resolution_clock::now();
+
+			std::print("WorkStealingPool fib({}) {} threads, serial {} use {}ms, fork/join {} use {}ms.\n", fib_n, ws_pool.size(),
+				serial, std::chrono::duration_cast<std::chrono::milliseconds>(mid_time - start_time).count(),
+				parallel, std::chrono::duration_cast<std::chrono::milliseconds>(end_time - mid_time).count());
+
+			//	ύSubmitstd::futureSubmitPooledػ TaskFuturePost޽Сհȶ״̬º߲ڴ
+			constexpr uint32_t submit_count = 1'000'000;
+			std::atomic<uint32_t> done{ 0 };
+			auto submit_bench = [&](const char* name, auto&& submit_all) {
+				done = 0;
+				auto start = std::chrono::high_resolution_clock::now();
+				submit_all();
+				while (done.load() < submit_count) {
+					std::this_thread::yield();
+				}
+				auto end = std::chrono::high_resolution_clock::now();
+				const auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+				std::print("WorkStealingPool {} {} tasks, use {}ms, {:.2f} Mtasks/s.\n", name, submit_count, us / 1000,
+					us > 0 ? static_cast<double>(submit_count) / us : 0.0);
+			};
+
+			submit_bench("Submit      ", [&]() {
+				std::vector<std::future<void>> futures;
+				futures.reserve(submit_count);
+				for (uint32_t i = 0; i < submit_count; ++i) {
+					futures.push_back(ws_pool.Submit([&done]() { done.fetch_add(1, std::memory_order_relaxed); }));
+				}
+				});
+			submit_bench("SubmitPooled", [&]() {
+				std::vector<TaskFuture<void>> futures;
+				futures.reserve(submit_count);
+				for (uint32_t i = 0; i < submit_count; ++i) {
+					futures.push_back(ws_pool.SubmitPooled([&done]() { done.fetch_add(1, std::memory_order_relaxed); }));
+				}
+				});
+			submit_bench("Post        ", [&]() {
+				for (uint32_t i = 0; i < submit_count; ++i) {
+					ws_pool.Post([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+				}
+				});
+		}
+
+		{
+			//	̰߳󶨣Compact  Scatter Ĵ䣬Լ NUMA ڵ㻮ֵ̳߳
+			const CpuTopology& topology = CpuTopology::Get();
+			const uint32_t count = static_cast<uint32_t>(topology.processors.size());
+			auto to_string = [](const std::vector<uint32_t>& list) {
+				std::string text;
+				for (uint32_t id : list) {
+					text += (text.empty() ? "" : " ") + std::to_string(id);
+				}
+				return text;
+			};
+			std::print("topology {} node(s), {} core(s), {} logical, compact [{}], scatter [{}].\n", topology.nodes, topology.cores, count,
+				to_string(topology.Compact(count)), to_string(topology.Scatter(count)));
+
+			constexpr uint32_t task_count = 200'000;
+			{
+				WorkStealingPool pool(count, WorkStealingPool::Placement::None);
+				FineGrainedBench("WorkStealingPool None   ", pool, task_count);
+			}
+			{
+				WorkStealingPool pool(count, WorkStealingPool::Placement::Compact);
+				FineGrainedBench("WorkStealingPool Compact", pool, task_count);
+			}
+			{
+				WorkStealingPool pool(count, WorkStealingPool::Placement::Scatter);
+				FineGrainedBench("WorkStealingPool Scatter", pool, task_count);
+			}
+			{
+				ThreadPool::Options options;
+				options.min_workers = options.max_workers = count;
+				options.placement = Placement::Compact;
+				ThreadPool pool(options);
+				FineGrainedBench("ThreadPool Compact      ", pool, task_count);
+			}
+
+			NumaPool numa_pool;
+			std::print("NumaPool {} node(s), {} threads.\n", numa_pool.nodes(), numa_pool.size());
+			NumaLocalityBench(numa_pool, 1ull << 22, 8);	//	ÿڵ 32MBڵ local  remote ͬ
+		}
+
+		{
+			//	㷨1..N ̵߳չԣԼڳڲǶ׵
+			constexpr size_t element_count = 4'000'000;
+			const uint32_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+			for (uint32_t threads = 1; threads < max_threads; threads *= 2) {
+				ParallelScalingBench(threads, element_count);
+			}
+			ParallelScalingBench(max_threads, element_count);
+
+			WorkStealingPool pool(2);
+			auto nested = pool.Submit([&pool]() {
+				std::vector<uint64_t> sums(64);
+				parallel_for(pool, size_t(0), sums.size(), [&](size_t i) {
+					std::vector<uint64_t> values(10'000, i);
+					sums[i] = parallel_reduce(pool, values.begin(), values.end(), uint64_t(0));
+					});
+				return std::accumulate(sums.begin(), sums.end(), uint64_t(0));
+				});
+			std::print("parallel nested in pool task (2 threads) : {}, expect {}.\n", pool.Wait(nested), 10'000ull * 63 * 64 / 2);
+		}
+
+		{
+			//	ʱ֣һԡȡԼ򼶶ʱģӳʱĲ롢ȡ봥ӳ
+			using Clock = TimerWheel::Clock;
+			std::atomic<uint32_t> ticks{ 0 };	//	ȡʱڹִ߳Уʱ̳߳ػþ
+			WorkStealingPool pool;
+			TimerWheel wheel(pool);
+
+			const auto begin = Clock::now();
+			wheel.schedule_after(50ms, [begin]() {
+				std::print("TimerWheel schedule_after 50ms fired after {}us.\n",
+					std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count());
+				});
+			const auto periodic = wheel.schedule_every(20ms, [&ticks]() { ticks.fetch_add(1); });
+			const auto cancelled = wheel.schedule_at(begin + 30ms, []() { std::print("TimerWheel cancelled timer fired!\n"); });
+			const bool cancel_ok = wheel.cancel(cancelled);
+			std::this_thread::sleep_for(210ms);
+			wheel.cancel(periodic);
+			std::print("TimerWheel periodic 20ms over 210ms fired {} times, cancel {}, cancel again {}.\n", ticks.load(), cancel_ok, wheel.cancel(cancelled));
+
+			constexpr uint32_t timer_count = 1'000'000;
+			std::atomic<uint32_t> fired{ 0 };
+			std::atomic<int64_t> max_late_us{ 0 };
+			std::vector<TimerWheel::TimerId> ids(timer_count);
+			uint64_t seed = 0x9E3779B97F4A7C15ull;
+
+			auto start_time = std::chrono::high_resolution_clock::now();
+			for (uint32_t i = 0; i < timer_count; ++i)
+			{
+				seed ^= seed << 13;
+				seed ^= seed >> 7;
+				seed ^= seed << 17;
+				const auto deadline = Clock::now() + std::chrono::milliseconds(1 + seed % 1000);
+				ids[i] = wheel.schedule_at(deadline, [&fired, &max_late_us, deadline]() {
+					const int64_t late = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - deadline).count();
+					int64_t prev = max_late_us.load(std::memory_order_relaxed);
+					while (late > prev && !max_late_us.compare_exchange_weak(prev, late, std::memory_order_relaxed)) {}
+					fired.fetch_add(1, std::memory_order_relaxed);
+					});
+			}
+			auto mid_time = std::chrono::high_resolution_clock::now();
+			uint32_t cancel_count = 0;
+			for (uint32_t i = 0; i < timer_count; i += 2) {
+				cancel_count += wheel.cancel(ids[i]) ? 1 : 0;
+			}
+			auto end_time = std::chrono::high_resolution_clock::now();
+
+			while (wheel.size() > 0 || fired.load() + cancel_count < timer_count) {
+				std::this_thread::sleep_for(10ms);
+			}
+			const auto schedule_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(mid_time - start_time).count();
+			const auto cancel_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - mid_time).count();
+			std::print("TimerWheel {} timers : schedule {}ns/op, cancel {} {}ns/op, fired {}, max late {}us.\n", timer_count,
+				schedule_ns / timer_count, cancel_count, cancel_ns / std::max(cancel_count, 1u), fired.load(), max_late_us.load());
+		}
+
+		{
+			//	ThreadPool ͻСڵʱؾ˯뻽
+			auto burst_bench = [](const char* name, std::chrono::microseconds spin) {
+				ThreadPool::Options options;
+				options.min_workers = options.max_workers = 2;
+				options.spin = spin;
+				ThreadPool pool(options);
+
+				constexpr uint32_t bursts = 2'000;
+				constexpr uint32_t burst_size = 8;
+				std::atomic<uint32_t> done{ 0 };
+				auto start_time = std::chrono::high_resolution_clock::now();
+				for (uint32_t b = 1; b <= bursts; ++b)
+				{
+					for (uint32_t k = 0; k < burst_size; ++k) {
+						pool.Post([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+					}
+					while (done.load() < b * burst_size) {
+						std::this_thread::yield();
+					}
+					const auto gap_end = std::chrono::high_resolution_clock::now() + 20us;
+					while (std::chrono::high_resolution_clock::now() < gap_end) {}
+				}
+				auto end_time = std::chrono::high_resolution_clock::now();
+
+				const ThreadPool::Stats stats = pool.stats();
+				std::print("ThreadPool {} {} bursts x {} : use {}ms, parks {}, queue delay mean {}us p50 <={}us p99 <={}us max {}us.\n", name,
+					bursts, burst_size, std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count(), stats.parks,
+					stats.delay_mean_us, stats.delay_p50_us, stats.delay_p99_us, stats.delay_max_us);
+			};
+			burst_bench("spin 0   ", 0us);
+			burst_bench("spin 50us", 50us);
+
+			//	̬߳Ŷӳ grow_delay ʱݵ max_workersг idle_timeout յ min_workers
+			ThreadPool::Options options;
+			options.min_workers = 1;
+			options.max_workers = 4;
+			options.grow_delay = 2ms;
+			options.idle_timeout = 200ms;
+			ThreadPool pool(options);
+
+			std::vector<std::future<void>> futures;
+			for (int i = 0; i < 32; ++i) {
+				futures.push_back(pool.Submit([]() { std::this_thread::sleep_for(10ms); }));
+			}
+			for (auto& f : futures) {
+				f.wait();
+			}
+			const ThreadPool::Stats busy = pool.stats();
+			std::this_thread::sleep_for(600ms);
+			const ThreadPool::Stats idle = pool.stats();
+			std::print("ThreadPool scaling : grown {}, peak {} workers, queue delay p99 <={}us; after idle {} workers, retired {}.\n",
+				busy.grown, busy.peak_workers, busy.delay_p99_us, idle.workers, idle.retired);
+		}
+
+		{
+			//	ͼֲͼ̳߳ϵ״ظпԼ쳣
+			WorkStealingPool pool;
+			TaskGraphBench("WorkStealingPool", pool);
+			TaskGraphBench("ThreadPool      ", ThreadPool::instance());
+
+			TaskGraph graph;
+			const auto a = graph.Emplace([]() {});
+			const auto b = graph.Emplace([]() { throw std::runtime_error("node b failed"); });
+			const auto c = graph.Emplace([]() { std::print("TaskGraph node c should not run!\n"); });
+			graph.Precede(a, b);
+			graph.Precede(b, c);
+			try {
+				graph.Run(pool);
+			}
+			catch (const std::exception& e) {
+				std::print("TaskGraph exception : {}.\n", e.what());
+			}
+			graph.Precede(c, a);
+			try {
+				graph.Run(pool);
+			}
+			catch (const std::exception& e) {
+				std::print("TaskGraph exception : {}.\n", e.what());
+			}
+		}
+
 		ThreadPool::instance().Stop();
 
 		std::print(" ===== STL_Thread End =====\n");